@@ -3,6 +3,8 @@
   Created by TheDIYGuy999, Oct 2016, December 2017
   Released into the public domain.
   V1.2, including STM32 ARM support
+  V1.3, non blocking: the 38kHz carrier is generated by Timer 2, the pulses are timed by Timer 1 (AVR only)
+  V1.4, the pulse tables are replaced with 12 bit code words, which are computed at compile time
 */
 
 #ifndef MeccanoIr_h
@@ -12,311 +14,247 @@
 
 //
 // =======================================================================================================
-// IR CODE DEFINITION
+// IR PROTOCOL DEFINITION
 // =======================================================================================================
 //
 
-// Meccano binary code: // means "1", no marking means "0"
-
-// CHANNEL A *************************************************
-
-// A + IR code---------------------------
-const byte IrSignalAplus[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 60, //
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  120, 240
+// Frame timing of an IR protocol (in 10's of microseconds): header, code word (MSB first), trailer
+// Marks are 38kHz modulated, a "1" bit has the long space
+struct irProtocol {
+  byte headerMark, headerSpace;
+  byte bitMark, zeroSpace, oneSpace;
+  byte trailerMark, trailerSpace;
+  byte bits; // code word length (max. 16)
 };
 
-// A - IR code---------------------------
-const byte IrSignalAminus[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 30,
-  30, 60, //
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  120, 240
-};
+// Protocols (one line each) ----
+const irProtocol meccanoProtocol PROGMEM = {180, 180, 30, 30, 60, 120, 240, 12};
 
-// A OFF IR code---------------------------
-const byte IrSignalAoff[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  120, 240
-};
+//
+// =======================================================================================================
+// MECCANO CODE WORDS (computed at compile time)
+// =======================================================================================================
+//
 
-// CHANNEL B *************************************************
-
-// B + IR code---------------------------
-const byte IrSignalBplus[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  120, 240
-};
+// Meccano code word: a 6 bit half word, which is sent twice: direction + / -, then channel A / B / C / D (one hot)
+enum { MECCANO_A, MECCANO_B, MECCANO_C, MECCANO_D };
+enum { MECCANO_OFF = 0b00, MECCANO_MINUS = 0b01, MECCANO_PLUS = 0b10 };
 
-// B - IR code---------------------------
-const byte IrSignalBminus[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  120, 240
-};
+constexpr uint16_t meccanoHalfWord(byte channel, byte direction) {
+  return (direction << 4) | (0b1000 >> channel);
+}
 
-// B OFF IR code---------------------------
-const byte IrSignalBoff[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  120, 240
-};
+constexpr uint16_t meccanoCode(byte channel, byte direction) {
+  return (meccanoHalfWord(channel, direction) << 6) | meccanoHalfWord(channel, direction);
+}
 
-// CHANNEL C *************************************************
-
-// C + IR code---------------------------
-const byte IrSignalCplus[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  120, 240
+// Same bits as the former IrSignalAplus, IrSignalBminus and IrSignalDoff pulse tables
+static_assert(meccanoCode(MECCANO_A, MECCANO_PLUS) == 0b101000101000, "MECCANO A+ code mismatch");
+static_assert(meccanoCode(MECCANO_B, MECCANO_MINUS) == 0b010100010100, "MECCANO B- code mismatch");
+static_assert(meccanoCode(MECCANO_D, MECCANO_OFF) == 0b000001000001, "MECCANO D OFF code mismatch");
+
+// Commands 1 - 12 for buildIrSignal() (one line per channel)
+const uint16_t meccanoCodes[] PROGMEM = {
+  meccanoCode(MECCANO_A, MECCANO_PLUS), meccanoCode(MECCANO_A, MECCANO_MINUS), meccanoCode(MECCANO_A, MECCANO_OFF), // 1 - 3
+  meccanoCode(MECCANO_B, MECCANO_PLUS), meccanoCode(MECCANO_B, MECCANO_MINUS), meccanoCode(MECCANO_B, MECCANO_OFF), // 4 - 6
+  meccanoCode(MECCANO_C, MECCANO_PLUS), meccanoCode(MECCANO_C, MECCANO_MINUS), meccanoCode(MECCANO_C, MECCANO_OFF), // 7 - 9
+  meccanoCode(MECCANO_D, MECCANO_PLUS), meccanoCode(MECCANO_D, MECCANO_MINUS), meccanoCode(MECCANO_D, MECCANO_OFF), // 10 - 12
 };
+const byte meccanoCommands = sizeof(meccanoCodes) / sizeof(uint16_t);
 
-// C - IR code---------------------------
-const byte IrSignalCminus[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  120, 240
-};
+//
+// =======================================================================================================
+// FRAME EXPANSION (streaming, one mark or space per call)
+// =======================================================================================================
+//
 
-// C OFF IR code---------------------------
-const byte IrSignalCoff[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  120, 240
-};
+// Returns the duration of a frame step in 10's of microseconds (0 = end of frame). Even steps are marks, odd steps are spaces
+byte irStepDuration(const irProtocol *protocol, uint16_t code, byte step) {
+  byte bits = pgm_read_byte(&protocol->bits);
 
-// CHANNEL D *************************************************
-
-// D + IR code---------------------------
-const byte IrSignalDplus[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  120, 240
-};
+  if (step == 0) return pgm_read_byte(&protocol->headerMark);
+  if (step == 1) return pgm_read_byte(&protocol->headerSpace);
 
-// D - IR code---------------------------
-const byte IrSignalDminus[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  120, 240
-};
+  step -= 2;
+  if (step < bits * 2) {
+    if ((step & 0x01) == 0) return pgm_read_byte(&protocol->bitMark);
+    if ((code >> (bits - 1 - step / 2)) & 0x01) return pgm_read_byte(&protocol->oneSpace);
+    return pgm_read_byte(&protocol->zeroSpace);
+  }
 
-// D OFF IR code---------------------------
-const byte IrSignalDoff[] PROGMEM = {
-  // ON, OFF (in 10's of microseconds)
-  180, 180,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 30,
-  30, 60, //
-  120, 240
-};
+  step -= bits * 2;
+  if (step == 0) return pgm_read_byte(&protocol->trailerMark);
+  if (step == 1) return pgm_read_byte(&protocol->trailerSpace);
+  return 0;
+}
+
+#if defined (__STM32F1__) // STM32 ARM board ----
 
 //
 // =======================================================================================================
-// IR SIGNAL GENERATION
+// IR SIGNAL GENERATION (blocking)
 // =======================================================================================================
 //
 
 void buildIrSignal(byte channel) {
 
-  const byte s = 28; // The length of the IR code arrays
-  byte IrSignal[s];
-
-  // 1. Read the array from PROGMEM ******
-  for (int i = 0; i < s; i++) {
-    if (channel == 1) IrSignal[i] = pgm_read_byte(&IrSignalAplus[i]); // Channel A+
-    if (channel == 2) IrSignal[i] = pgm_read_byte(&IrSignalAminus[i]); // Channel A-
-    if (channel == 3) IrSignal[i] = pgm_read_byte(&IrSignalAoff[i]); // Channel A OFF
+  BENCH_START(BENCH_IR);
 
-    if (channel == 4) IrSignal[i] = pgm_read_byte(&IrSignalBplus[i]); // Channel B+
-    if (channel == 5) IrSignal[i] = pgm_read_byte(&IrSignalBminus[i]); // Channel B-
-    if (channel == 6) IrSignal[i] = pgm_read_byte(&IrSignalBoff[i]); // Channel B OFF
+  if (channel < 1 || channel > meccanoCommands) return;
+  uint16_t code = pgm_read_word(&meccanoCodes[channel - 1]);
 
-    if (channel == 7) IrSignal[i] = pgm_read_byte(&IrSignalCplus[i]); // Channel C+
-    if (channel == 8) IrSignal[i] = pgm_read_byte(&IrSignalCminus[i]); // Channel C-
-    if (channel == 9) IrSignal[i] = pgm_read_byte(&IrSignalCoff[i]); // Channel C OFF
+  // Generate the IR pulses ******
+  byte duration;
+  for (byte step = 0; (duration = irStepDuration(&meccanoProtocol, code, step)) > 0; step ++) {
+    if ((step & 0x01) == 0) { // HIGH (38KHz modulated) ----
+      long microsecs = duration * 10;
+      while (microsecs > 0) {
+        digitalWrite(PB5, HIGH); //Pin PB5 is hardcoded!
+        delayMicroseconds(12);
+        digitalWrite(PB5, LOW); //Pin PB5 is hardcoded!
+        delayMicroseconds(12);
 
-    if (channel == 10) IrSignal[i] = pgm_read_byte(&IrSignalDplus[i]); // Channel D+
-    if (channel == 11) IrSignal[i] = pgm_read_byte(&IrSignalDminus[i]); // Channel D-
-    if (channel == 12) IrSignal[i] = pgm_read_byte(&IrSignalDoff[i]); // Channel D OFF
+        microsecs -= 26; // 38 kHz is about 13 microseconds high and 13 microseconds low
+      }
+    }
+    else { // LOW ----
+      delayMicroseconds(duration * 10);
+    }
   }
+  delay(30);
 
-  // 2. Generate the IR pulses ******
-  for (int i = 0; i < (s - 1); i = i + 2) {
-    // HIGH (38KHz modulated) ----
-    long microsecs = IrSignal[i] * 10;
-    while (microsecs > 0) {
-
-#if defined (__STM32F1__) // STM32 ARM board ----
-      digitalWrite(PB5, HIGH); //Pin PB5 is hardcoded!
-      delayMicroseconds(12);
-      digitalWrite(PB5, LOW); //Pin PB5 is hardcoded!
-      delayMicroseconds(12);
+  BENCH_STOP(BENCH_IR);
+}
 // STM32 ARM board end ----
 
 #else // AVR board ----
-      digitalWrite(3, HIGH); //Pin 3 is hardcoded!
-#if F_CPU == 16000000 // 16MHz CPU
-      delayMicroseconds(10); // We don't want the delay on an 8MHz board!
-#endif
-      digitalWrite(3, LOW); //Pin 3 is hardcoded!
-#if F_CPU == 16000000 // 16MHz CPU
-      delayMicroseconds(10); // We don't want the delay on an 8MHz board!
-#endif
 
-#endif // AVR board end ----
+//
+// =======================================================================================================
+// IR SIGNAL GENERATION (timer driven, non blocking)
+// =======================================================================================================
+//
 
-      microsecs -= 26; // 38 kHz is about 13 microseconds high and 13 microseconds low
-    }
+// Timer 2 generates the 38kHz carrier on pin 3 (OC2B), Timer 1 times the marks & spaces. Pin 3 is hardcoded!
+// Both timers run with prescaler 8. Timer 1 ticks = microseconds * irTicksPerMicrosecond
+const byte irCarrierTop = F_CPU / 8 / 38000 - 1; // 38kHz
+const byte irTicksPerMicrosecond = F_CPU / 8000000;
+const unsigned int irFrameGap = 30000; // microseconds pause after each frame (was delay(30))
+
+// Command queue (filled in the main loop, emptied in the Timer 1 interrupt), max. one waiting command per motor
+const byte irQueueSize = 8; // must be a power of 2
+static_assert(irQueueSize > meccanoCommands / 3, "One entry per motor and one free entry are required");
+volatile byte irQueue[irQueueSize];
+volatile byte irQueueHead = 0; // next free entry (written in the main loop only)
+volatile byte irQueueTail = 0; // next command to send (written in the interrupt only)
+volatile boolean irActive = false; // a frame is being sent
+
+// State of the frame in the air (interrupt only)
+uint16_t irCode;
+byte irStep;
+boolean irFrameDone;
+
+// Carrier ON / OFF ----
+inline void irCarrierOn() {
+  TCCR2A |= _BV(COM2B1); // connect OC2B (pin 3) to the PWM
+}
+
+inline void irCarrierOff() {
+  TCCR2A &= ~_BV(COM2B1); // disconnect OC2B, pin 3 goes back to its port value (LOW)
+}
+
+// Start the next mark or space with the given duration ----
+inline void irSetDuration(unsigned int microseconds) {
+  OCR1A = microseconds * irTicksPerMicrosecond - 1;
+}
 
-    // LOW ----
-    delayMicroseconds(IrSignal[i + 1] * 10);
+// Next step of the frame (called at the end of each mark and space) ----
+void irNextStep() {
 
-  } // End of for loop
-  delay(30);
+  byte duration = irFrameDone ? 0 : irStepDuration(&meccanoProtocol, irCode, irStep);
+
+  if (duration > 0) { // Marks (even steps) and spaces (odd steps), expanded from the code word
+    if ((irStep & 0x01) == 0) irCarrierOn();
+    else irCarrierOff();
+    irSetDuration(duration * 10);
+    irStep ++;
+  }
+  else if (!irFrameDone) { // Pause after the frame
+    irCarrierOff();
+    irSetDuration(irFrameGap);
+    irFrameDone = true;
+  }
+  else if (irQueueTail != irQueueHead) { // Next frame from the queue
+    irCode = pgm_read_word(&meccanoCodes[irQueue[irQueueTail] - 1]);
+    irQueueTail = (irQueueTail + 1) & (irQueueSize - 1);
+    irStep = 0;
+    irFrameDone = false;
+    irNextStep();
+  }
+  else { // Queue empty: stop Timer 1
+    TCCR1B = 0;
+    TIMSK1 &= ~_BV(OCIE1A);
+    irActive = false;
+  }
+}
+
+ISR(TIMER1_COMPA_vect) {
+  irNextStep();
+}
+
+// Queue a command (returns immediately) ----
+void buildIrSignal(byte channel) {
+
+  BENCH_START(BENCH_IR);
+
+  if (channel >= 1 && channel <= meccanoCommands) {
+
+    // A waiting command of the same motor (3 commands each) is replaced, so the latest joystick position wins.
+    // Interrupts are disabled, so the interrupt can't take the entry, while it is replaced
+    byte motor = (channel - 1) / 3;
+    boolean queued = false;
+    noInterrupts();
+    for (byte i = irQueueTail; i != irQueueHead; i = (i + 1) & (irQueueSize - 1)) {
+      if ((irQueue[i] - 1) / 3 == motor) {
+        irQueue[i] = channel;
+        queued = true;
+      }
+    }
+    if (!queued) { // the queue can't be full (one entry per motor)
+      irQueue[irQueueHead] = channel;
+      irQueueHead = (irQueueHead + 1) & (irQueueSize - 1);
+    }
+    interrupts();
+
+    // Start the timers, if idle
+    if (!irActive) {
+      irActive = true;
+
+      // Timer 2: fast PWM, TOP = OCR2A, 50% duty cycle on OC2B, carrier disconnected
+      digitalWrite(3, LOW);
+      pinMode(3, OUTPUT);
+      TCCR2A = _BV(WGM21) | _BV(WGM20);
+      TCCR2B = _BV(WGM22) | _BV(CS21);
+      OCR2A = irCarrierTop;
+      OCR2B = irCarrierTop / 2;
+
+      // Timer 1: CTC mode, compare A interrupt
+      noInterrupts();
+      TCCR1A = 0;
+      TCCR1B = _BV(WGM12);
+      TCNT1 = 0;
+      irFrameDone = true; // the first interrupt loads the frame from the queue
+      irSetDuration(10);
+      TIFR1 = _BV(OCF1A);
+      TIMSK1 |= _BV(OCIE1A);
+      TCCR1B |= _BV(CS11); // prescaler 8, start
+      interrupts();
+    }
+  }
+
+  BENCH_STOP(BENCH_IR);
 }
 
+#endif // AVR board end ----
+
 #endif
@@ -12,7 +12,7 @@
 // NRF24L01+PA+LNA SMA radio modules with power amplifier are supported from board version 1.1
 // ATARI PONG game :-) Press the "Back" button during power on to start it
 
-const float codeVersion = 2.51; // Software revision
+const float codeVersion = 2.6; // Software revision
 
 //
 // =======================================================================================================
@@ -20,8 +20,18 @@ const float codeVersion = 2.51; // Software revision
 // =======================================================================================================
 //
 
-//#define DEBUG // if not commented out, Serial.print() is active! For debugging only!!
+//#define DEBUG // if not commented out, the radio details and the memory report are printed via Serial during the setup! For debugging only!!
 //#define OLED_DEBUG // if not commented out, an additional diagnostics screen is shown during startup
+//#define BENCHMARK // if not commented out, execution times of the time critical functions are printed via Serial (see benchmark.h)
+//#define LINK_STATS // if not commented out, the radio link statistics are printed via Serial every second (see linkStats.h)
+//#define PACKED_PROTOCOL // if not commented out, the bit packed radio protocol is used (requires a receiver with packed protocol support, see protocol.h)
+//#define RECORDER // if not commented out, the sent frames are recorded via Serial and can be replayed (binary, see recorder.h)
+//#define TELEMETRY // if not commented out, axes, link, battery and timing records are sent via Serial (binary, non blocking, see telemetry.h)
+
+// Serial is using pins 0 & 1, so the "SEL" & "LEFT" buttons can't be used with these options
+#if defined DEBUG || defined BENCHMARK || defined LINK_STATS || defined RECORDER || defined TELEMETRY
+#define SERIAL_USED
+#endif
 
 //
 // =======================================================================================================
@@ -31,7 +41,7 @@ const float codeVersion = 2.51; // Software revision
 
 // Libraries
 #include <SPI.h>
-#include <RF24.h> // Installed via Sketch > Include Library > Manage Libraries > Type "RF24" (use V1.3.3!)
+#include <RF24.h> // Installed via Sketch > Include Library > Manage Libraries > Type "RF24" (V1.4.0 or newer, getARC() is required)
 #include <printf.h>
 #include <EEPROMex.h> // https://github.com/thijse/Arduino-EEPROMEx
 #include <LegoIr.h> // https://github.com/TheDIYGuy999/LegoIr
@@ -63,6 +73,12 @@ const byte NRFchannel[] {
   1, 2
 };
 
+// Hop table for the packed protocol: primary & spare channel of each slot (see hopping.h). Must match with the receiver!
+// Channels 0 - 83 only (2.400 - 2.483GHz ISM band). The legacy channels 1 & 2 are included for the radio tester search
+const byte hopTable[4][2] {
+  {1, 42}, {2, 62}, {22, 82}, {12, 72}
+};
+
 // the ID number of the used "radio pipe" must match with the selected ID on the transmitter!
 // 20 ID's are available @ the moment
 const uint64_t pipeOut[] PROGMEM = {
@@ -88,19 +104,36 @@ struct RcData {
   byte pot1; // Potentiometer
 };
 RcData data;
+int axisFine[4] = {500, 500, 500, 500}; // high resolution axes 0 - 1000 (0.1% steps, sent with the packed protocol only)
+int quickTrim[4]; // trim of the active vehicle in 0.1% steps (quick trim screen, not stored in the EEPROM)
+byte trimAxis = 0; // the selected axis on the quick trim screen
 
-// This struct defines data, which are embedded inside the ACK payload
+// This struct defines data, which are embedded inside the ACK payload (legacy protocol, see protocol.h)
 struct ackPayload {
   float vcc; // vehicle vcc voltage
   float batteryVoltage; // vehicle battery voltage
   boolean batteryOk; // the vehicle battery voltage is OK!
+  byte channel; // the channel number
+};
+
+// Vehicle telemetry, received in the ACK payload (or sent in radio tester mode)
+struct telemetryData {
+  uint16_t vcc; // vehicle vcc voltage in mV
+  uint16_t batteryVoltage; // vehicle battery voltage in mV
+  boolean batteryOk; // the vehicle battery voltage is OK!
   byte channel = 1; // the channel number
 };
-ackPayload payload;
+telemetryData payload;
 
 // Did the receiver acknowledge the sent data?
 boolean transmissionState;
 
+// Non blocking radio transmission (the NRF24L01 handles the auto retransmits in the background)
+boolean txBusy = false; // a frame is in the air, waiting for ACK or max. retries
+unsigned long txStartMicros; // start of the current frame
+const unsigned long txTimeout = 10000; // us, the frame is dropped, if the radio did not report a result (5 x 1.5ms retries max.)
+unsigned long previousSuccessfulTransmission; // millis() of the last ACK with payload
+
 // LEGO powerfunctions IR
 LegoIr pf;
 int pfChannel;
@@ -109,56 +142,16 @@ const int pfMaxAddress = 3;
 // TX voltages
 boolean batteryOkTx = false;
 #define BATTERY_DETECT_PIN A7 // The 20k & 10k battery detection voltage divider is connected to pin A7
-float txVcc;
-float txBatt;
-
-//Joystick reversing
-boolean joystickReversed[maxVehicleNumber + 1][4] = { // 1 + 10 Vehicle Addresses, 4 Servos
-  {false, false, false, false}, // Address 0 used for EEPROM initialisation
-
-  {false, false, false, false}, // Address 1
-  {false, false, false, false}, // Address 2
-  {false, false, false, false}, // Address 3
-  {false, false, false, false}, // Address 4
-  {false, false, false, false}, // Address 5
-  {false, false, false, false}, // Address 6
-  {false, false, false, false}, // Address 7
-  {false, false, false, false}, // Address 8
-  {false, false, false, false}, // Address 9
-  {false, false, false, false}, // Address 10
-};
-
-//Joystick percent negative
-byte joystickPercentNegative[maxVehicleNumber + 1][4] = { // 1 + 10 Vehicle Addresses, 4 Servos
-  {100, 100, 100, 100}, // Address 0 not used
-
-  {100, 100, 100, 100}, // Address 1
-  {100, 100, 100, 100}, // Address 2
-  {100, 100, 100, 100}, // Address 3
-  {100, 100, 100, 100}, // Address 4
-  {100, 100, 100, 100}, // Address 5
-  {100, 100, 100, 100}, // Address 6
-  {100, 100, 100, 100}, // Address 7
-  {100, 100, 100, 100}, // Address 8
-  {100, 100, 100, 100}, // Address 9
-  {100, 100, 100, 100}, // Address 10
-};
-
-//Joystick percent positive
-byte joystickPercentPositive[maxVehicleNumber + 1][4] = { // 1 + 10 Vehicle Addresses, 4 Channels
-  {100, 100, 100, 100}, // Address 0 not used
-
-  {100, 100, 100, 100}, // Address 1
-  {100, 100, 100, 100}, // Address 2
-  {100, 100, 100, 100}, // Address 3
-  {100, 100, 100, 100}, // Address 4
-  {100, 100, 100, 100}, // Address 5
-  {100, 100, 100, 100}, // Address 6
-  {100, 100, 100, 100}, // Address 7
-  {100, 100, 100, 100}, // Address 8
-  {100, 100, 100, 100}, // Address 9
-  {100, 100, 100, 100}, // Address 10
+uint16_t txVcc; // mV
+uint16_t txBatt; // mV
+
+// Settings of the active vehicle (only this one is kept in RAM, loaded from the EEPROM, see settings.h)
+struct vehicleSettings {
+  byte reversed; // Joystick reversing, bit 0 - 3 = channel 1 - 4
+  byte percentNegative[4]; // Joystick travel negative
+  byte percentPositive[4]; // Joystick travel positive
 };
+vehicleSettings settings;
 
 // Joysticks
 #define JOYSTICK_1 A1
@@ -170,45 +163,25 @@ byte joystickPercentPositive[maxVehicleNumber + 1][4] = { // 1 + 10 Vehicle Addr
 #define JOYSTICK_BUTTON_LEFT 4
 #define JOYSTICK_BUTTON_RIGHT 2
 
-byte leftJoystickButtonState;
-byte rightJoystickButtonState;
-
 // Buttons
 #define BUTTON_LEFT 1 // - or channel select
 #define BUTTON_RIGHT 10 // + or transmission mode select
 #define BUTTON_SEL 0 // select button for menu
 #define BUTTON_BACK 9 // back button for menu
 
-byte leftButtonState = 7; // init states with 7 (see macro below)!
-byte rightButtonState = 7;
-byte selButtonState = 7;
-byte backButtonState = 7;
-
-// macro for detection of rising edge and debouncing
-/*the state argument (which must be a variable) records the current and the last 3 reads
-  by shifting one bit to the left at each read and bitwise anding with 15 (=0b1111).
-  If the value is 7(=0b0111) we have one raising edge followed by 3 consecutive 1's.
-  That would qualify as a debounced raising edge*/
-#define DRE(signal, state) (state=(state<<1)|(signal&1)&15)==7
-
-// Status LED objects (false = logic not inverted)
-#ifdef ledInversed // inversed logic
-statusLED greenLED(true); // green: ON = transmitter ON, flashing = Communication with vehicle OK
-statusLED redLED(true); // red: ON = battery empty
-#endif
-#ifndef ledInversed // not inversed logic
-statusLED greenLED(false); // green: ON = transmitter ON, flashing = Communication with vehicle OK
-statusLED redLED(false); // red: ON = battery empty
-#endif
+// Status LED objects (false = logic not inverted, see transmitterConfig.h)
+statusLED greenLED(txProfile::ledInversed); // green: ON = transmitter ON, flashing = Communication with vehicle OK
+statusLED redLED(txProfile::ledInversed); // red: ON = battery empty
 
 // OLED display. Select the one you have! Otherwise sthe sreen could be slightly offset sideways!
 //U8GLIB_SH1106_128X64 u8g(U8G_I2C_OPT_FAST);  // I2C / TWI  FAST instead of NONE = 400kHz I2C!
 U8GLIB_SSD1306_128X64 u8g(U8G_I2C_OPT_FAST);  // I2C / TWI  FAST instead of NONE = 400kHz I2C!
 int activeScreen = 0; // the currently displayed screen number (0 = splash screen)
-boolean displayLocked = true;
+boolean displayRequested = false; // a display refresh was requested (all requests are merged into one frame)
+boolean displayBusy = false; // a frame is in progress (one page is rendered per display task call)
 byte menuRow = 0; // Menu active cursor line
 
-// EEPROM (max. total size is 512 bytes)
+// EEPROM legacy layout (only read, if a vehicle has no record in the settings journal yet, see settings.h)
 // Always get the adresses first and in the same order
 // Blocks of 21 x 4 bytes = 84 bytes each!
 int addressReverse = EEPROM.getAddress(sizeof(byte) * 84);
@@ -222,11 +195,43 @@ int addressPositive = EEPROM.getAddress(sizeof(byte) * 84);
 //
 
 // Tabs (header files in sketch directory)
+#include "benchmark.h" // Execution time measurement (must be included first)
+#include "adcScan.h" // Interrupt driven analog input scan
 #include "readVCC.h"
 //#include "transmitterConfig.h"
 #include "MeccanoIr.h" // https://github.com/TheDIYGuy999/MeccanoIr
 #include "pong.h" // A little pong game :-)
 #include "pgmRead64.h" // Read 64 bit blocks from PROGMEM
+#include "displayFilter.h" // Only changed display pages are sent via I2C
+#include "scheduler.h" // Fixed rate task scheduler
+#include "buttons.h" // Interrupt driven button events
+#include "hopping.h" // Frequency hopping with channel rating
+#include "protocol.h" // Legacy or bit packed radio protocol
+#include "linkStats.h" // Loss, retries and round trip time of the radio link
+#include "linkControl.h" // Link adaptive data rate & PA level
+#include "settings.h" // Journaled vehicle settings in the EEPROM
+#include "memory.h" // RAM usage & stack depth measurement
+#include "analyzer.h" // Link analyzer for the radio tester mode
+#include "discovery.h" // Scan for vehicles on all pipe addresses
+#include "tdma.h" // Time sliced control of several vehicles
+#include "battery.h" // Battery discharge model & runtime estimation
+#include "power.h" // Adaptive frame rate & idle sleep
+#include "recorder.h" // Frame recorder & replay via Serial
+#include "telemetry.h" // Binary telemetry stream via Serial
+
+// Tasks (the order is the priority, see setupTasks())
+enum {
+  TASK_CONTROL, // Joysticks, radio & IR transmission (the control path)
+  TASK_BUTTONS,
+  TASK_LED,
+  TASK_BATTERY,
+  TASK_DISPLAY,
+  TASK_SETTINGS, // EEPROM writes (the background tasks have to be the last ones!)
+  TASK_PONG,
+  TASK_RADIO, // Radio status polling in the idle time
+  TASK_COUNT
+};
+schedulerTask tasks[TASK_COUNT];
 
 //
 // =======================================================================================================
@@ -236,20 +241,24 @@ int addressPositive = EEPROM.getAddress(sizeof(byte) * 84);
 
 void setupRadio() {
   radio.begin();
+#ifdef PACKED_PROTOCOL
+  radio.setChannel(hopChannel(0));
+#else
   radio.setChannel(NRFchannel[chPointer]);
+#endif
 
   radio.powerUp();
 
-  // Set Power Amplifier (PA) level to one of four levels: RF24_PA_MIN, RF24_PA_LOW, RF24_PA_HIGH and RF24_PA_MAX
-  if (boardVersion < 1.1 ) radio.setPALevel(RF24_PA_MIN); // No independent NRF24L01 3.3V PSU, so only "MIN" transmission level allowed
-  else radio.setPALevel(RF24_PA_MAX); // Independent NRF24L01 3.3V PSU, so "FULL" transmission level allowed
+  // Max. Power Amplifier (PA) level, one of four levels: RF24_PA_MIN, RF24_PA_LOW, RF24_PA_HIGH and RF24_PA_MAX
+  if (txProfile::boardVersion < 11) paLimit = RF24_PA_MIN; // No independent NRF24L01 3.3V PSU, so only "MIN" transmission level allowed
+  else paLimit = RF24_PA_MAX; // Independent NRF24L01 3.3V PSU, so "FULL" transmission level allowed
 
-  radio.setDataRate(RF24_250KBPS);
+  resetLinkControl(); // Start with 250kbps and the max. PA level, adapted to the link quality later on (see linkControl.h)
   //radio.setAutoAck(pipeOut[vehicleNumber - 1], true); // Ensure autoACK is enabled
   radio.setAutoAck(pgm_read_64(&pipeOut, vehicleNumber - 1), true); // Ensure autoACK is enabled
   radio.enableAckPayload();
   radio.enableDynamicPayloads();
-  radio.setRetries(5, 5);                  // 5x250us delay (blocking!!), max. 5 retries
+  radio.setRetries(5, 5);                  // 5x250us delay, max. 5 retries (non blocking, see transmitRadio())
   //radio.setCRCLength(RF24_CRC_8);          // Use 8-bit CRC for performance*/
 
 #ifdef DEBUG
@@ -262,12 +271,14 @@ void setupRadio() {
   data.axis2 = 50;
   data.axis3 = 50;
   data.axis4 = 50;
+  for (byte i = 0; i < 4; i++) axisFine[i] = 500;
 
   // Transmitter
+  txBusy = false; // radio.begin() has flushed a pending frame
   if (operationMode == 0) {
     //radio.openWritingPipe(pipeOut[vehicleNumber - 1]); // Vehicle Number 1 = Array number 0, so -1!
     radio.openWritingPipe(pgm_read_64(&pipeOut, vehicleNumber - 1)); // Vehicle Number 1 = Array number 0, so -1!
-    radio.write(&data, sizeof(RcData));
+    // The first frame is sent by transmitRadio() in the next control task pass (no blocking write here)
   }
 
   // Receiver (radio tester mode)
@@ -278,6 +289,26 @@ void setupRadio() {
   }
 }
 
+// Fast vehicle change: only the pipe address is changed, the radio is not re-initialized ----
+void setupPipe() {
+
+  // Transmitter
+  if (operationMode == 0) {
+    if (txBusy) radio.flush_tx(); // drop the frame to the previous vehicle
+    txBusy = false;
+    resetLinkControl(); // the new vehicle starts with 250kbps, it doesn't know the data rate of the previous one
+    radio.openWritingPipe(pgm_read_64(&pipeOut, vehicleNumber - 1));
+  }
+
+  // Receiver (radio tester mode)
+  if (operationMode == 1) {
+    radio.stopListening();
+    radio.openReadingPipe(1, pgm_read_64(&pipeOut, vehicleNumber - 1));
+    radio.startListening();
+    analyzerReset(); // the statistics of the previous vehicle are not valid anymore
+  }
+}
+
 //
 // =======================================================================================================
 // LEGO POWERFUNCTIONS SETUP
@@ -300,12 +331,16 @@ void setupPowerfunctions() {
 
 void setup() {
 
-#ifdef DEBUG
+#if defined DEBUG || defined BENCHMARK || defined LINK_STATS
   Serial.begin(115200);
   printf_begin();
   delay(3000);
 #endif
 
+#if defined RECORDER || defined TELEMETRY
+  Serial.begin(115200); // binary records only
+#endif
+
   // LED setup
   greenLED.begin(6); // Green LED on pin 5
   redLED.begin(5); // Red LED on pin 6
@@ -318,22 +353,16 @@ void setup() {
   pinMode(BUTTON_SEL, INPUT_PULLUP);
   pinMode(BUTTON_BACK, INPUT_PULLUP);
 
-  // EEPROM setup
-  EEPROM.readBlock(addressReverse, joystickReversed); // restore all arrays from the EEPROM
-  EEPROM.readBlock(addressNegative, joystickPercentNegative);
-  EEPROM.readBlock(addressPositive, joystickPercentPositive);
+  // EEPROM setup: find the latest settings records
+  settingsScan();
 
-  if (joystickReversed[0][0] || (!digitalRead(BUTTON_BACK) && !digitalRead(BUTTON_SEL))) { // 255 is EEPROM default after a program download,
-    // this indicates that we have to initialise the EEPROM with our default values! Or manually triggered with
+  if (!digitalRead(BUTTON_BACK) && !digitalRead(BUTTON_SEL)) { // Reset all vehicles to the default values, manually triggered with
     // both "SEL" & "BACK" buttons pressed during switching on!
-    memset(joystickReversed, 0, sizeof(joystickReversed)); // init arrays first
-    memset(joystickPercentNegative, 100, sizeof(joystickPercentNegative));
-    memset(joystickPercentPositive, 100, sizeof(joystickPercentPositive));
-    EEPROM.updateBlock(addressReverse, joystickReversed); // then write defaults to EEPROM
-    EEPROM.updateBlock(addressNegative, joystickPercentNegative);
-    EEPROM.updateBlock(addressPositive, joystickPercentPositive);
+    settingsReset();
   }
 
+  settingsLoad(vehicleNumber); // only the settings of the active vehicle are loaded
+
   // Switch to radio tester mode, if "Select" button is pressed
   if (digitalRead(BUTTON_BACK) && !digitalRead(BUTTON_SEL)) {
     operationMode = 1;
@@ -344,7 +373,13 @@ void setup() {
     operationMode = 2;
   }
 
+  // Battery models
+  batteryReset(txBattery, txCells);
+  batteryReset(vehicleBattery, 0); // LiPo cells are detected
+
   // Joystick setup
+  setupAdcScan(); // Start the background analog input scan
+  buildTransforms(); // Compute the channel transforms for the active vehicle
   JoystickOffset(); // Compute all joystick center points
   readJoysticks(); // Then do the first jocstick read
 
@@ -359,6 +394,7 @@ void setup() {
   u8g.setDefaultForegroundColor();
   u8g.setFontPosTop();
   u8g.setFont(u8g_font_6x10);
+  setupDisplayFilter(u8g);
 
   // Splash screen
   checkBattery();
@@ -371,6 +407,16 @@ void setup() {
 #endif
   activeScreen = 1; // switch to the main screen
   delay(1500);
+
+  // Button events (the buttons, which are still pressed from the mode selection, are ignored)
+  setupButtons();
+
+  // Task scheduler setup
+  setupTasks();
+
+#if defined DEBUG || defined BENCHMARK || defined LINK_STATS
+  printMemoryReport(); // static RAM & stack depth during the setup
+#endif
 }
 
 //
@@ -386,124 +432,248 @@ void travelAdjust(boolean upDn) {
   else inc = -5; // -
 
   if ( (menuRow & 0x01) == 0) { // even (2nd column)
-    joystickPercentPositive[vehicleNumber][(menuRow - 6) / 2 ] += inc; // row 6 - 12 = 0 - 3
+    settings.percentPositive[(menuRow - 6) / 2 ] += inc; // row 6 - 12 = 0 - 3
   }
   else { // odd (1st column)
-    joystickPercentNegative[vehicleNumber][(menuRow - 5) / 2 ] += inc;  // row 5 - 11 = 0 - 3
+    settings.percentNegative[(menuRow - 5) / 2 ] += inc;  // row 5 - 11 = 0 - 3
   }
-  joystickPercentPositive[vehicleNumber][(menuRow - 6) / 2 ] = constrain(joystickPercentPositive[vehicleNumber][(menuRow - 6) / 2 ], 20, 100);
-  joystickPercentNegative[vehicleNumber][(menuRow - 5) / 2 ] = constrain(joystickPercentNegative[vehicleNumber][(menuRow - 5) / 2 ], 20, 100);
+  settings.percentPositive[(menuRow - 6) / 2 ] = constrain(settings.percentPositive[(menuRow - 6) / 2 ], 20, 100);
+  settings.percentNegative[(menuRow - 5) / 2 ] = constrain(settings.percentNegative[(menuRow - 5) / 2 ], 20, 100);
 }
 
-// Main buttons function --------------------------------------------------------------------------
-void readButtons() {
+// Sub function for the vehicle change ------------------------------------------------------------
+void selectVehicle(int number) {
+  if (tdmaActive) tdmaStop(); // back to a single vehicle
+  vehicleNumber = number;
+  memset(quickTrim, 0, sizeof(quickTrim)); // the trim belongs to the vehicle
+  batteryReset(vehicleBattery, 0); // an other vehicle battery
+  settingsLoad(vehicleNumber);
+  buildTransforms(); // Joystick transforms with the settings of the new vehicle
+  setupPipe(); // New pipe address only (the radio was already initialized)
+  setupPowerfunctions(); // Re-initialize the LEGO IR transmitter with the new channel address
+  requestDisplay();
+}
 
-  // Every 10 ms
-  static unsigned long lastTrigger;
-  if (millis() - lastTrigger >= 10) {
-    lastTrigger = millis();
+// Sub function for the vehicle discovery: runs in the radio task instead of the status polling ----------
+void setDiscovery(boolean on) {
+  if (on == discoveryActive) return;
+  if (on) {
+    if (tdmaActive) tdmaStop(); // the group is started again with the "BACK" button
+    discoveryStart();
+  }
+  else {
+    discoveryStop();
+    setupPipe(); // back to the active vehicle
+  }
+  tasks[TASK_RADIO].function = on ? discoveryTask : pollRadio;
+}
 
-    // Left joystick button (Mode 1)
-    if (DRE(digitalRead(JOYSTICK_BUTTON_LEFT), leftJoystickButtonState) && (transmissionMode == 1)) {
-      data.mode1 = !data.mode1;
-      drawDisplay();
+// Sub function for the TDMA group mode (needs at least 2 vehicles) -------------------------------
+void startTdma() {
+  if (tdmaActive || !tdmaStart()) return;
+  buildTransforms(); // without the settings of the active vehicle
+  requestDisplay();
+}
+
+// Sub function for the quick trim (+ or -) --------------------------------------------------------
+void trimAdjust(boolean upDn) {
+  if (upDn) quickTrim[trimAxis] += 5; // 0.5% steps
+  else quickTrim[trimAxis] -= 5;
+  quickTrim[trimAxis] = constrain(quickTrim[trimAxis], -100, 100); // max. 10%
+}
+
+// Button clicks -----------------------------------------------------------------------------------
+void buttonClick(byte button) {
+
+  // Left joystick button (Mode 1)
+  if (button == BTN_JOYSTICK_LEFT && (transmissionMode == 1)) {
+    data.mode1 = !data.mode1;
+    requestDisplay();
+  }
+
+  // Right joystick button (Mode 2, adds / removes the selected vehicle to / from the group on the discovery screen)
+  if (button == BTN_JOYSTICK_RIGHT && (transmissionMode == 1)) {
+    if (activeScreen == 13) {
+      if (discoveryCursor != discoveryNone) tdmaToggle(discoveryCursor);
     }
+    else data.mode2 = !data.mode2;
+    requestDisplay();
+  }
 
-    // Right joystick button (Mode 2)
-    if (DRE(digitalRead(JOYSTICK_BUTTON_RIGHT), rightJoystickButtonState) && (transmissionMode == 1)) {
-      data.mode2 = !data.mode2;
-      drawDisplay();
+  if (activeScreen == 2) { // if analyzer is displayed ----------
+
+    // Right button: export the analyzer data via Serial
+    if (button == BTN_RIGHT) analyzerExport();
+
+    // Left button: reset the analyzer
+    if (button == BTN_LEFT) {
+      analyzerReset();
+      requestDisplay();
     }
+  }
+  else if (activeScreen == 3) { // if quick trim is displayed ----------
 
-    if (activeScreen <= 10) { // if menu is not displayed ----------
+    // Left button: Trim +, Right button: Trim -
+    if (button == BTN_LEFT) trimAdjust(true);
+    if (button == BTN_RIGHT) trimAdjust(false);
 
-      // Left button: Channel selection +
-      if (DRE(digitalRead(BUTTON_LEFT), leftButtonState) && (transmissionMode < 3)) {
-        vehicleNumber ++;
-        if (vehicleNumber > maxVehicleNumber) vehicleNumber = 1;
-        setupRadio(); // Re-initialize the radio with the new pipe address
-        setupPowerfunctions(); // Re-initialize the LEGO IR transmitter with the new channel address
-        drawDisplay();
-      }
+    // Select button: next axis
+    if (button == BTN_SEL) trimAxis = (trimAxis + 1) & 0x03;
 
-      // Right button: Change transmission mode. Radio <> IR
-      if (infrared) { // only, if transmitter has IR option
-        if (DRE(digitalRead(BUTTON_RIGHT), rightButtonState)) {
-          if (transmissionMode < 3) transmissionMode ++;
-          else {
-            transmissionMode = 1;
-            setupRadio(); // Re-initialize radio, if we switch back to radio mode!
-          }
-          drawDisplay();
+    // Back button: back to the main screen
+    if (button == BTN_BACK) activeScreen = 1;
+    requestDisplay();
+    return;
+  }
+  else if (activeScreen <= 10) { // if menu is not displayed ----------
+
+    // Left button: Channel selection +
+    if (button == BTN_LEFT && (transmissionMode < 3)) {
+      if (vehicleNumber < maxVehicleNumber) selectVehicle(vehicleNumber + 1);
+      else selectVehicle(1);
+    }
+
+    // Right button: Change transmission mode. Radio <> IR
+    if (txProfile::infrared) { // only, if transmitter has IR option
+      if (button == BTN_RIGHT) {
+        if (transmissionMode < 3) transmissionMode ++;
+        else {
+          transmissionMode = 1;
+          setupRadio(); // Re-initialize radio, if we switch back to radio mode!
         }
+        buildTransforms(); // IR modes are not using the vehicle settings
+        requestDisplay();
       }
-      else { // only, if transmitter has no IR option
-        // Right button: Channel selection -
-        if (DRE(digitalRead(BUTTON_RIGHT), rightButtonState) && (transmissionMode < 3)) {
-          vehicleNumber --;
-          if (vehicleNumber < 1) vehicleNumber = maxVehicleNumber;
-          setupRadio(); // Re-initialize the radio with the new pipe address
-          setupPowerfunctions(); // Re-initialize the LEGO IR transmitter with the new channel address
-          drawDisplay();
-        }
+    }
+    else { // only, if transmitter has no IR option
+      // Right button: Channel selection -
+      if (button == BTN_RIGHT && (transmissionMode < 3)) {
+        if (vehicleNumber > 1) selectVehicle(vehicleNumber - 1);
+        else selectVehicle(maxVehicleNumber);
       }
     }
-    else { // if menu is displayed -----------
-      // Right button: Value -
-      if (DRE(digitalRead(BUTTON_RIGHT), rightButtonState)) {
-        if (activeScreen == 11) {
-          joystickReversed[vehicleNumber][menuRow - 1] = false;
-        }
-        if (activeScreen == 12) {
-          travelAdjust(false); // -
-        }
-        drawDisplay();
+  }
+  else { // if menu is displayed -----------
+    // Right button: Value -
+    if (button == BTN_RIGHT) {
+      if (activeScreen == 11) {
+        bitClear(settings.reversed, menuRow - 1);
       }
-
-      // Left button: Value +
-      if (DRE(digitalRead(BUTTON_LEFT), leftButtonState)) {
-        if (activeScreen == 11) {
-          joystickReversed[vehicleNumber][menuRow - 1] = true;
-        }
-        if (activeScreen == 12) {
-          travelAdjust(true); // +
-        }
-        drawDisplay();
+      if (activeScreen == 12) {
+        travelAdjust(false); // -
+      }
+      if (activeScreen == 13) {
+        discoveryMove(false); // previous found vehicle
       }
+      requestDisplay();
     }
 
-    // Menu buttons:
-
-    // Select button: opens the menu and scrolls through menu entries
-    if (DRE(digitalRead(BUTTON_SEL), selButtonState) && (transmissionMode == 1)) {
-      activeScreen = 11; // 11 = Menu screen 1
-      menuRow ++;
-      if (menuRow > 4) activeScreen = 12; // 12 = Menu screen 2
-      if (menuRow > 12) {
-        activeScreen = 11; // Back to menu 1, entry 1
-        menuRow = 1;
+    // Left button: Value +
+    if (button == BTN_LEFT) {
+      if (activeScreen == 11) {
+        bitSet(settings.reversed, menuRow - 1);
+      }
+      if (activeScreen == 12) {
+        travelAdjust(true); // +
+      }
+      if (activeScreen == 13) {
+        discoveryMove(true); // next found vehicle
       }
-      drawDisplay();
+      requestDisplay();
     }
+  }
 
-    // Back / Momentary button:
-    if (activeScreen <= 10) { // Momentary button, if menu is NOT displayed
-      if (!digitalRead(BUTTON_BACK)) data.momentary1 = true;
-      else data.momentary1 = false;
+  // Menu buttons:
+
+  // Select button: opens the menu and scrolls through menu entries
+  if (button == BTN_SEL && (transmissionMode == 1)) {
+    activeScreen = 11; // 11 = Menu screen 1
+    menuRow ++;
+    if (menuRow == 13 && operationMode != 0) menuRow ++; // no vehicle discovery in the radio tester mode
+    if (menuRow > 4) activeScreen = 12; // 12 = Menu screen 2
+    if (menuRow > 12) activeScreen = 13; // 13 = Vehicle discovery screen
+    if (menuRow > 13) activeScreen = 100; // 100 = Diagnostics screen
+    if (menuRow > 14) activeScreen = 101; // 101 = Link diagnostics screen
+    if (menuRow > 15) activeScreen = 102; // 102 = Memory diagnostics screen
+    if (menuRow > 16) activeScreen = 103; // 103 = Battery diagnostics screen
+    if (menuRow > 17) activeScreen = 104; // 104 = Power diagnostics screen
+    if (menuRow > 18) {
+      activeScreen = 11; // Back to menu 1, entry 1
+      menuRow = 1;
+    }
+    requestDisplay();
+  }
+
+  // Back button:
+  if (button == BTN_BACK) {
+    if (activeScreen <= 10) { // Radio tester mode: toggles the analyzer screen (momentary button in transmitter mode)
+      if (operationMode == 1) {
+        if (activeScreen == 2) activeScreen = 1; // 1 = Main screen
+        else activeScreen = 2; // 2 = Analyzer screen
+        requestDisplay();
+      }
     }
     else { // Goes back to the main screen & saves the changed entries in the EEPROM
-      if (DRE(digitalRead(BUTTON_BACK), backButtonState)) {
-        activeScreen = 1; // 1 = Main screen
-        menuRow = 0;
-        drawDisplay();
-        EEPROM.updateBlock(addressReverse, joystickReversed); // update changed values in EEPROM
-        EEPROM.updateBlock(addressNegative, joystickPercentNegative);
-        EEPROM.updateBlock(addressPositive, joystickPercentPositive);
+      boolean discovery = (activeScreen == 13);
+      activeScreen = 1; // 1 = Main screen
+      menuRow = 0;
+      buildTransforms(); // Apply the changed values
+      requestDisplay();
+      settingsSave(vehicleNumber); // the changed values are written into the EEPROM in the background
+      setDiscovery(false);
+      if (discovery) {
+        if (tdmaMembers() >= 2) startTdma(); // control all vehicles of the group
+        else if (discoveryCursor != discoveryNone) selectVehicle(discoveryCursor + 1); // jump to the vehicle, which was selected in the list
       }
     }
   }
 }
 
+// Long button presses -----------------------------------------------------------------------------
+void buttonLong(byte button) {
+
+  // Select button: opens and closes the quick trim screen (transmitter mode)
+  if (button == BTN_SEL && operationMode == 0) {
+    if (activeScreen == 1) activeScreen = 3; // 3 = Quick trim screen
+    else if (activeScreen == 3) activeScreen = 1;
+    requestDisplay();
+  }
+}
+
+// Double clicks (only for the buttons in buttonsDoubleMask) ---------------------------------------
+void buttonDouble(byte button) {
+
+  // Select button: resets the trim of the selected axis
+  if (button == BTN_SEL && activeScreen == 3) {
+    quickTrim[trimAxis] = 0;
+    requestDisplay();
+  }
+}
+
+// Main buttons function --------------------------------------------------------------------------
+void readButtons() {
+
+  // Called every 10 ms by the scheduler. The button edges are recorded by the pin change interrupt (see buttons.h),
+  // the long press & double click times are checked here
+  buttonsUpdate();
+
+  byte button, event;
+  while (buttonsNext(button, event)) {
+    if (event == BUTTON_CLICK) buttonClick(button);
+    if (event == BUTTON_LONG) buttonLong(button);
+    if (event == BUTTON_DOUBLE) buttonDouble(button);
+  }
+
+  // Momentary button, if neither the menu nor the quick trim is displayed (transmitter mode)
+  if (operationMode != 1) data.momentary1 = (activeScreen <= 2) && buttonPressed(BTN_BACK);
+
+  // Double clicks are only used on the quick trim screen (the click is delayed)
+  buttonsDoubleMask = (activeScreen == 3) ? bit(BTN_SEL) : 0;
+
+  // The vehicle discovery is running, while its screen is displayed
+  setDiscovery(activeScreen == 13);
+}
+
 //
 // =======================================================================================================
 // JOYSTICKS
@@ -514,74 +684,117 @@ int offset[4]; // the auto calibration offset of each joystick
 
 // Auto-zero subfunction (called during setup, if a pot and no 3 position switch is connected) ----
 void JoystickOffset() {
-#ifndef CH1Switch
-  offset[0] = 512 - analogRead(JOYSTICK_1);
-#endif
-
-#ifndef CH2Switch
-  offset[1] = 512 - analogRead(JOYSTICK_2);
-#endif
+  if (hasPot(0)) offset[0] = 512 - adcRead(JOYSTICK_1); // constant conditions, see transmitterConfig.h
+  if (hasPot(1)) offset[1] = 512 - adcRead(JOYSTICK_2);
+  if (hasPot(2)) offset[2] = 512 - adcRead(JOYSTICK_3);
+  if (hasPot(3)) offset[3] = 512 - adcRead(JOYSTICK_4);
+}
 
-#ifndef CH3Switch
-  offset[2] = 512 - analogRead(JOYSTICK_3);
-#endif
+// Precomputed channel transform (rebuilt, if the vehicle, the transmission mode or a menu value has changed) ----
+// Piecewise linear: (x0, y0) - (x1, y1) - x2 with fixed point slopes. x0 - x1 = throttle reverse range enhancement
+struct axisTransform {
+  int x0, x1, x2; // input (joystick reading + offset): lower limit, knee point, upper limit
+  int y0, y1; // output @ x0 and x1
+  long slopeA, slopeB; // output steps per input step * 65536, below and above the knee point
+  int yMin, yMax; // output limits (channel travel)
+};
+axisTransform transform[4];
 
-#ifndef CH4Switch
-  offset[3] = 512 - analogRead(JOYSTICK_4);
-#endif
-}
+// Reference mapping, scaling and reversing, output 0 - 1000 (only used for the transform calculation) ----
+int referenceMapJoystick(int reading, byte arrayNo) {
+  const int range = txProfile::range(arrayNo);
+  const int center = txProfile::range(2) / 2;
 
-// Mapping and reversing subfunction ----
-byte mapJoystick(byte input, byte arrayNo) {
-  int reading[4];
-  reading[arrayNo] = analogRead(input) + offset[arrayNo]; // read joysticks and add the offset
-  reading[arrayNo] = constrain(reading[arrayNo], (1023 - range[arrayNo]), range[arrayNo]); // then limit the result before we do more calculations below
+  reading = constrain(reading, (1023 - range), range); // limit the reading before we do more calculations below
 
-#ifndef CONFIG_4_CH // In most "car style" transmitters, less than one half of the throttle potentiometer range is used for the reverse. So we have to enhance this range!
-  if (reading[2] < (range[2] / 2) ) {
-    reading[2] = constrain(reading[2], reverseEndpoint, (range[2] / 2)); // limit reverse range, which will be mapped later on
-    reading[2] = map(reading[2], reverseEndpoint, (range[2] / 2), 0, (range[2] / 2)); // reverse range mapping (adjust reverse endpoint in transmitterConfig.h)
+  // In most "car style" transmitters, less than one half of the throttle potentiometer range is used for the reverse. So we have to enhance this range!
+  if (arrayNo == 2 && reading < center ) {
+    reading = constrain(reading, txProfile::reverseEndpoint, center); // limit reverse range, which will be mapped later on
+    reading = map(reading, txProfile::reverseEndpoint, center, 0, center); // reverse range mapping (adjust reverse endpoint in transmitterConfig.h)
   }
-#endif
 
-  if (transmissionMode == 1 && operationMode != 2 ) { // Radio mode and not game mode
-    if (joystickReversed[vehicleNumber][arrayNo]) { // reversed
-      return map(reading[arrayNo], (1023 - range[arrayNo]), range[arrayNo], (joystickPercentPositive[vehicleNumber][arrayNo] / 2 + 50), (50 - joystickPercentNegative[vehicleNumber][arrayNo] / 2));
+  if (transmissionMode == 1 && operationMode != 2 && !(tdmaActive && tdmaVehicleSettings)) { // Radio mode and not game mode (TDMA: the settings of each vehicle are applied in tdmaEncode())
+    if (bitRead(settings.reversed, arrayNo)) { // reversed
+      return map(reading, (1023 - range), range, (settings.percentPositive[arrayNo] / 2 + 50) * 10, (50 - settings.percentNegative[arrayNo] / 2) * 10);
     }
     else { // not reversed
-      return map(reading[arrayNo], (1023 - range[arrayNo]), range[arrayNo], (50 - joystickPercentNegative[vehicleNumber][arrayNo] / 2), (joystickPercentPositive[vehicleNumber][arrayNo] / 2 + 50));
+      return map(reading, (1023 - range), range, (50 - settings.percentNegative[arrayNo] / 2) * 10, (settings.percentPositive[arrayNo] / 2 + 50) * 10);
     }
   }
   else { // IR mode
-    return map(reading[arrayNo], (1023 - range[arrayNo]), range[arrayNo], 0, 100);
+    return map(reading, (1023 - range), range, 0, 1000);
   }
 }
 
+// Fixed point slope between two points ----
+long transformSlope(int xa, int ya, int xb, int yb) {
+  if (xb <= xa) return 0;
+  return ((long)(yb - ya) << 16) / (xb - xa);
+}
+
+// Build the transforms of all channels for the active vehicle ----
+void buildTransforms() {
+  for (byte i = 0; i < 4; i++) {
+    axisTransform &t = transform[i];
+
+    t.x0 = 1023 - txProfile::range(i);
+    t.x2 = txProfile::range(i);
+    t.x1 = t.x0; // no knee point
+    if (i == 2) { // throttle reverse range enhancement
+      t.x0 = constrain(txProfile::reverseEndpoint, t.x0, t.x2);
+      t.x1 = constrain(txProfile::range(2) / 2, t.x0, t.x2);
+    }
+
+    t.y0 = referenceMapJoystick(t.x0, i);
+    t.y1 = referenceMapJoystick(t.x1, i);
+    int y2 = referenceMapJoystick(t.x2, i);
+
+    t.slopeA = transformSlope(t.x0, t.y0, t.x1, t.y1);
+    t.slopeB = transformSlope(t.x1, t.y1, t.x2, y2);
+
+    t.yMin = max(min(min(t.y0, y2), t.y1), 0);
+    t.yMax = max(max(t.y0, y2), t.y1);
+  }
+}
+
+// Mapping and reversing subfunction, output 0 - 1000 (one multiplication per sample, no division) ----
+int mapJoystick(byte input, byte arrayNo) {
+  const axisTransform &t = transform[arrayNo];
+  int reading = adcRead(input) + offset[arrayNo]; // read the latest joystick sample (no waiting) and add the offset
+  int y;
+
+  reading = constrain(reading, t.x0, t.x2);
+  if (reading < t.x1) y = t.y0 + (int)(((reading - t.x0) * t.slopeA + 0x8000) >> 16);
+  else y = t.y1 + (int)(((reading - t.x1) * t.slopeB + 0x8000) >> 16);
+
+  return constrain(y + quickTrim[arrayNo], t.yMin, t.yMax);
+}
+
 // Main Joystick function ----
 void readJoysticks() {
 
-  // save previous joystick positions
-  byte previousAxis1 = data.axis1;
-  byte previousAxis2 = data.axis2;
-  byte previousAxis3 = data.axis3;
-  byte previousAxis4 = data.axis4;
+  BENCH_START(BENCH_JOYSTICKS);
 
-  // Read current joystick positions, then scale and reverse output signals, if necessary (only for the channels we have)
-#ifdef CH1
-  data.axis1 = mapJoystick(JOYSTICK_1, 0); // Aileron (Steering for car)
-#endif
+  // Read current joystick positions, then scale and reverse output signals, if necessary (only for the channels we have, the others are removed at compile time)
+  if (hasChannel(0)) {
+    axisFine[0] = mapJoystick(JOYSTICK_1, 0); // Aileron (Steering for car)
+    data.axis1 = (axisFine[0] + 5) / 10; // 0 - 100 for the legacy protocol, IR and the display
+  }
 
-#ifdef CH2
-  data.axis2 = mapJoystick(JOYSTICK_2, 1); // Elevator
-#endif
+  if (hasChannel(1)) {
+    axisFine[1] = mapJoystick(JOYSTICK_2, 1); // Elevator
+    data.axis2 = (axisFine[1] + 5) / 10; // 0 - 100 for the legacy protocol, IR and the display
+  }
 
-#ifdef CH3
-  data.axis3 = mapJoystick(JOYSTICK_3, 2); // Throttle
-#endif
+  if (hasChannel(2)) {
+    axisFine[2] = mapJoystick(JOYSTICK_3, 2); // Throttle
+    data.axis3 = (axisFine[2] + 5) / 10; // 0 - 100 for the legacy protocol, IR and the display
+  }
 
-#ifdef CH4
-  data.axis4 = mapJoystick(JOYSTICK_4, 3); // Rudder
-#endif
+  if (hasChannel(3)) {
+    axisFine[3] = mapJoystick(JOYSTICK_4, 3); // Rudder
+    data.axis4 = (axisFine[3] + 5) / 10; // 0 - 100 for the legacy protocol, IR and the display
+  }
 
   // in case of an overflow, set axis to zero (prevent it from overflowing < 0)
   if (data.axis1 > 150) data.axis1 = 0;
@@ -589,16 +802,7 @@ void readJoysticks() {
   if (data.axis3 > 150) data.axis3 = 0;
   if (data.axis4 > 150) data.axis4 = 0;
 
-  // Only allow display refresh, if no value has changed!
-  if (previousAxis1 != data.axis1 ||
-      previousAxis2 != data.axis2 ||
-      previousAxis3 != data.axis3 ||
-      previousAxis4 != data.axis4) {
-    displayLocked = true;
-  }
-  else {
-    displayLocked = false;
-  }
+  BENCH_STOP(BENCH_JOYSTICKS);
 }
 
 //
@@ -608,7 +812,7 @@ void readJoysticks() {
 //
 
 void readPotentiometer() {
-  data.pot1 = map(analogRead(A6), 0, 1023, 0, 100);
+  data.pot1 = map(adcRead(A6), 0, 1023, 0, 100);
   data.pot1 = constrain(data.pot1, 0, 100);
 }
 
@@ -618,48 +822,59 @@ void readPotentiometer() {
 // =======================================================================================================
 //
 
-void transmitLegoIr() {
-  static byte speedOld[2];
-  static byte speed[2];
-  static byte pwm[2];
-  static unsigned long previousMillis;
+// Speed steps: joystick position 0 - 100 = step 0 - 14 (REV7 ... BRK ... FWD7)
+#define PF6(n) n, n, n, n, n, n // 6 positions per step
+const byte pfSteps[101] PROGMEM = {
+  PF6(0), PF6(1), PF6(2), PF6(3), PF6(4), PF6(5), PF6(6), // 0 - 41 = REV7 - REV1
+  PF6(7), PF6(7), 7, 7, 7, 7, // 42 - 57 = BRK
+  PF6(8), PF6(9), PF6(10), PF6(11), PF6(12), PF6(13), // 58 - 93 = FWD1 - FWD6
+  14, 14, 14, 14, 14, 14, 14 // 94 - 100 = FWD7
+};
+
+// PWM commands for each speed step
+const byte pfPwm[15] PROGMEM = {
+  PWM_REV7, PWM_REV6, PWM_REV5, PWM_REV4, PWM_REV3, PWM_REV2, PWM_REV1,
+  PWM_BRK,
+  PWM_FWD1, PWM_FWD2, PWM_FWD3, PWM_FWD4, PWM_FWD5, PWM_FWD6, PWM_FWD7
+};
+
+const byte pfHysteresis = 2; // the joystick has to pass a step boundary by this value, until the step changes
+const unsigned long pfKeepAlive = 600; // ms, one IR packet at least every 1.2s is required in order to prevent the vehicle from stopping
 
-  unsigned long currentMillis = millis();
+void transmitLegoIr() {
+  static byte step[2] = {7, 7}; // quantized speed of both motors (7 = BRK)
+  static unsigned long lastSent; // keep alive timer (both channels are sent in the same packet)
+  byte speed[2];
+  boolean send = false;
 
   // Flash green LED
   greenLED.flash(30, 2000, 0, 0);
 
   // store joystick positions into an array-----
-  speed[0] = data.axis3;
-  speed[1] = data.axis2;
-
-  // compute pwm value for "red" and "blue" motor, if speed has changed more than +/- 3, or every 0.6s
-  // NOTE: one IR pulse at least every 1.2 s is required in order to prevent the vehivle from stopping
-  // due to a signal timeout!
-  for (int i = 0; i <= 1; i++) {
-    if ((speedOld[i] - 3) > speed[i] || (speedOld[i] + 3) < speed[i] || currentMillis - previousMillis >= 600) {
-      speedOld[i] = speed[i];
-      previousMillis = currentMillis;
-      if (speed[i] >= 0 && speed[i] < 6) pwm[i] = PWM_REV7;
-      else if (speed[i] >= 6 && speed[i] < 12) pwm[i] = PWM_REV6;
-      else if (speed[i] >= 12 && speed[i] < 18) pwm[i] = PWM_REV5;
-      else if (speed[i] >= 18 && speed[i] < 24) pwm[i] = PWM_REV4;
-      else if (speed[i] >= 24 && speed[i] < 30) pwm[i] = PWM_REV3;
-      else if (speed[i] >= 30 && speed[i] < 36) pwm[i] = PWM_REV2;
-      else if (speed[i] >= 36 && speed[i] < 42) pwm[i] = PWM_REV1;
-      else if (speed[i] >= 42 && speed[i] < 58) pwm[i] = PWM_BRK;
-      else if (speed[i] >= 58 && speed[i] < 64) pwm[i] = PWM_FWD1;
-      else if (speed[i] >= 64 && speed[i] < 70) pwm[i] = PWM_FWD2;
-      else if (speed[i] >= 70 && speed[i] < 76) pwm[i] = PWM_FWD3;
-      else if (speed[i] >= 76 && speed[i] < 82) pwm[i] = PWM_FWD4;
-      else if (speed[i] >= 82 && speed[i] < 88) pwm[i] = PWM_FWD5;
-      else if (speed[i] >= 88 && speed[i] < 94) pwm[i] = PWM_FWD6;
-      else if (speed[i] >= 94) pwm[i] = PWM_FWD7;
-
-      // then transmit IR data
-      pf.combo_pwm(pwm[1], pwm[0]); // red and blue in one IR package
+  speed[0] = min(data.axis3, 100);
+  speed[1] = min(data.axis2, 100);
+
+  // quantize the speed with hysteresis around the step boundaries
+  for (byte i = 0; i <= 1; i++) {
+    byte up = pgm_read_byte(&pfSteps[max(speed[i] - pfHysteresis, 0)]);
+    byte down = pgm_read_byte(&pfSteps[min(speed[i] + pfHysteresis, 100)]);
+
+    if (up > step[i]) {
+      step[i] = up;
+      send = true;
+    }
+    else if (down < step[i]) {
+      step[i] = down;
+      send = true;
     }
   }
+  if (millis() - lastSent >= pfKeepAlive) send = true;
+
+  // then transmit one IR packet for both channels, if a step has changed or the keep alive time is over
+  if (send) {
+    pf.combo_pwm(pgm_read_byte(&pfPwm[step[1]]), pgm_read_byte(&pfPwm[step[0]])); // red and blue in one IR package
+    lastSent = millis();
+  }
 }
 
 //
@@ -684,7 +899,7 @@ void transmitMeccanoIr() {
     A = true;
   }
   if (data.axis1 < 10) { // A -
-    buildIrSignal(2), A = true;
+    buildIrSignal(2);
     A = true;
   }
   if (data.axis1 < 90 && data.axis1 > 10 && A) { // A OFF
@@ -698,7 +913,7 @@ void transmitMeccanoIr() {
     B = true;
   }
   if (data.axis2 < 10) { // B -
-    buildIrSignal(5), A = true;
+    buildIrSignal(5);
     B = true;
   }
   if (data.axis2 < 90 && data.axis2 > 10 && B) { // B OFF
@@ -712,7 +927,7 @@ void transmitMeccanoIr() {
     C = true;
   }
   if (data.axis3 < 10) { // C -
-    buildIrSignal(8), A = true;
+    buildIrSignal(8);
     C = true;
   }
   if (data.axis3 < 90 && data.axis3 > 10 && C) { // C OFF
@@ -726,7 +941,7 @@ void transmitMeccanoIr() {
     D = true;
   }
   if (data.axis4 < 10) { // D -
-    buildIrSignal(11), A = true;
+    buildIrSignal(11);
     D = true;
   }
   if (data.axis4 < 90 && data.axis4 > 10 && D) { // D OFF
@@ -741,87 +956,142 @@ void transmitMeccanoIr() {
 // =======================================================================================================
 //
 
+// Check, if the current frame is finished (status polling, never waits for the radio). Called in the idle time, so the round trip time is precise ----
+void pollRadio() {
+
+  if (!txBusy) return;
+
+  bool txOk, txFail, rxReady;
+  radio.whatHappened(txOk, txFail, rxReady); // read and clear the status flags
+  unsigned long rtt = micros() - txStartMicros;
+  boolean linkUp = millis() - (tdmaActive ? tdmaStats[tdmaSlot].lastAck : previousSuccessfulTransmission) < 1000;
+  byte sequence = (txSequence - 1) & 0x0F; // the sequence number was incremented after the frame was sent
+
+  if (txOk) { // ACK received
+    txBusy = false;
+    byte retries = radio.getARC(); // auto retransmits of the last frame
+    byte echo = 0xFF;
+    hopResult(true, retries, linkUp);
+    powerFrameResult(true);
+    if (radio.isAckPayloadAvailable()) {
+      byte ack[maxFrameSize];
+      byte len = radio.getDynamicPayloadSize();
+      if (len > maxFrameSize) len = maxFrameSize;
+      radio.read(ack, len); // read the payload, if available
+      if (tdmaActive) tdmaAck(ack, len); // the payload & the last ACK of each vehicle are kept separately
+      else if (decodeAck(ack, len, echo)) previousSuccessfulTransmission = millis(); // legacy or packed format, detected by the length
+    }
+#ifdef RECORDER
+    recorderResult(true, retries);
+#endif
+    if (tdmaActive) { // the frames are sent to several vehicles
+      tdmaResult();
+      linkRecord(true, retries, rtt, sequence, 0xFF);
+    }
+    else {
+      linkRecord(true, retries, rtt, sequence, echo);
+      rateResult(true, retries);
+    }
+  }
+  else if (txFail || rtt > (tdmaActive ? tdmaTimeout : txTimeout)) { // max. retries reached or no answer from the radio
+    byte retries = radio.getARC(); // auto retransmits of the last frame
+    radio.flush_tx(); // drop the frame, a new one with the latest joystick data is sent by transmitRadio()
+    txBusy = false;
+    hopResult(false, 0, linkUp);
+    powerFrameResult(false);
+    linkRecord(false, retries, rtt, sequence, 0xFF);
+    if (!tdmaActive) rateResult(false, retries);
+#ifdef RECORDER
+    recorderResult(false, retries);
+#endif
+  }
+}
+
 void transmitRadio() {
 
   static boolean previousTransmissionState;
-  static float previousRxVcc;
-  static float previousRxVbatt;
+  static uint16_t previousRxVcc;
+  static uint16_t previousRxVbatt;
   static boolean previousBattState;
-  static unsigned long previousSuccessfulTransmission;
+
+  BENCH_START(BENCH_RADIO);
 
   if (transmissionMode == 1) { // If radio mode is active: ----
 
-    // Send radio data and check if transmission was successful
-    if (radio.write(&data, sizeof(struct RcData)) ) {
-      if (radio.isAckPayloadAvailable()) {
-        radio.read(&payload, sizeof(struct ackPayload)); // read the payload, if available
-        previousSuccessfulTransmission = millis();
-      }
+    // Check, if the previous frame was transmitted successfully (usually done by the radio task in the idle time)
+    pollRadio();
+
+    // Full frame rate, if the inputs are changing, keep-alive frames otherwise (see power.h)
+    boolean frameDue = powerFrameDue();
+
+    // Send the latest data, if the previous frame is finished. There is no queue, so no outdated frames are sent
+    if (!txBusy && frameDue) {
+      // TDMA: the next vehicle of the group (pipe address & sequence number)
+      if (tdmaActive) tdmaNext();
+
+      // Switch channel for this transmission
+      radio.setChannel(hopNext(txSequence));
+
+      byte frame[maxFrameSize];
+      byte len = tdmaActive ? tdmaEncode(frame) : encodeRcData(frame);
+      radio.startWrite(frame, len, false); // returns immediately, result is checked in the next pass
+      txSequence = (txSequence + 1) & 0x0F;
+      txStartMicros = micros();
+      txBusy = true;
+      powerFrameSent();
+#ifdef RECORDER
+      recorderFrame();
+#endif
+#ifdef TELEMETRY
+      telemetryFrame(false); // the sent axes
+#endif
     }
 
-    // Switch channel for next transmission
-    chPointer ++;
-    if (chPointer >= sizeof((*NRFchannel) / sizeof(byte))) chPointer = 0;
-    radio.setChannel(NRFchannel[chPointer]);
+    linkUpdate(); // link statistics, every second
+    if (tdmaActive) tdmaUpdate(); // update rate of every vehicle, every second
 
-    // if the transmission was not confirmed (from the receiver) after > 1s...
-    if (millis() - previousSuccessfulTransmission > 1000) {
+    // if the transmission was not confirmed (from the receiver, TDMA: from every vehicle of the group) after > 1s...
+    unsigned long lastAck = tdmaActive ? tdmaLastAck() : previousSuccessfulTransmission;
+    if (millis() - lastAck > 1000) {
       greenLED.on();
       transmissionState = false;
-      memset(&payload, 0, sizeof(payload)); // clear the payload array, if transmission error
-#ifdef DEBUG
-      Serial.println("Data transmission error, check receiver!");
-#endif
+      payload = telemetryData(); // clear the payload, if transmission error
+      payload.channel = 0; // no channel
     }
     else {
       greenLED.flash(30, 100, 0, 0); //30, 100
       transmissionState = true;
-#ifdef DEBUG
-      Serial.println("Data successfully transmitted");
-#endif
     }
 
-    if (!displayLocked) { // Only allow display refresh, if not locked ----
-      // refresh transmission state on the display, if changed
-      if (transmissionState != previousTransmissionState) {
-        previousTransmissionState = transmissionState;
-        drawDisplay();
-      }
-
-      // refresh Rx Vcc on the display, if changed more than +/- 0.05V
-      if (payload.vcc - 0.05 >= previousRxVcc || payload.vcc + 0.05 <= previousRxVcc) {
-        previousRxVcc = payload.vcc;
-        drawDisplay();
-      }
+    // refresh transmission state on the display, if changed (the requests are merged into one display frame)
+    if (transmissionState != previousTransmissionState) {
+      previousTransmissionState = transmissionState;
+      requestDisplay();
+    }
 
-      // refresh Rx V Batt on the display, if changed more than +/- 0.3V
-      if (payload.batteryVoltage - 0.3 >= previousRxVbatt || payload.batteryVoltage + 0.3 <= previousRxVbatt) {
-        previousRxVbatt = payload.batteryVoltage;
-        drawDisplay();
-      }
+    // refresh Rx Vcc on the display, if changed more than +/- 0.05V
+    if (abs((int)(payload.vcc - previousRxVcc)) >= 50) {
+      previousRxVcc = payload.vcc;
+      requestDisplay();
+    }
 
-      // refresh battery state on the display, if changed
-      if (payload.batteryOk != previousBattState) {
-        previousBattState = payload.batteryOk;
-        drawDisplay();
-      }
+    // refresh Rx V Batt on the display, if changed more than +/- 0.3V
+    if (abs((int)(payload.batteryVoltage - previousRxVbatt)) >= 300) {
+      previousRxVbatt = payload.batteryVoltage;
+      requestDisplay();
     }
 
-#ifdef DEBUG
-    Serial.print(data.axis1);
-    Serial.print("\t");
-    Serial.print(data.axis2);
-    Serial.print("\t");
-    Serial.print(data.axis3);
-    Serial.print("\t");
-    Serial.print(data.axis4);
-    Serial.print("\t");
-    Serial.println(F_CPU / 1000000, DEC);
-#endif
+    // refresh battery state on the display, if changed
+    if (payload.batteryOk != previousBattState) {
+      previousBattState = payload.batteryOk;
+      requestDisplay();
+    }
   }
   else { // else infrared mode is active: ----
     radio.powerDown();
   }
+
+  BENCH_STOP(BENCH_RADIO);
 }
 
 //
@@ -833,34 +1103,47 @@ void transmitRadio() {
 void readRadio() {
 
   static unsigned long lastRecvTime = 0;
+  static unsigned long lastSearchTime = 0;
   byte pipeNo;
 
-  payload.batteryVoltage = txBatt; // store the battery voltage for sending
-  payload.vcc = txVcc; // store the vcc voltage for sending
-  payload.batteryOk = batteryOkTx; // store the battery state for sending
-
-  if (radio.available(&pipeNo)) {
-    radio.writeAckPayload(pipeNo, &payload, sizeof(struct ackPayload) );  // prepare the ACK payload
-    radio.read(&data, sizeof(struct RcData)); // read the radia data and send out the ACK payload
+  while (radio.available(&pipeNo)) { // drain the whole RX FIFO
+    unsigned long timestamp = micros(); // frames in the FIFO get the same time stamp (the radio task is polling in the idle time)
+    byte buf[maxFrameSize];
+    byte len = radio.getDynamicPayloadSize();
+    if (len > maxFrameSize) len = maxFrameSize;
+    radio.read(buf, len); // read the radia data
+    if (!decodeRcData(buf, len)) continue; // legacy or packed format, other protocol versions are ignored
+    analyzerRecord(timestamp, payload.channel, rxPacked, rxSequence);
+    if (rxPacked) rateFollow(); // switch the data rate, if requested and confirmed
+
+    payload.batteryVoltage = txBatt; // store the battery voltage for sending (mV)
+    payload.vcc = txVcc; // store the vcc voltage for sending (mV)
+    payload.batteryOk = batteryOkTx; // store the battery state for sending
+    radio.writeAckPayload(pipeNo, buf, encodeAck(buf)); // prepare the ACK payload for the next frame (same format, sequence number echo)
     lastRecvTime = millis();
-#ifdef DEBUG
-    Serial.print(data.axis1);
-    Serial.print("\t");
-    Serial.print(data.axis2);
-    Serial.print("\t");
-    Serial.print(data.axis3);
-    Serial.print("\t");
-    Serial.print(data.axis4);
-    Serial.println("\t");
+
+    // Follow the hop sequence of the packed protocol (the legacy transmitter comes back to this channel)
+    if (rxPacked) hopFollow(rxSequence, rxHopMask, timestamp);
+#ifdef TELEMETRY
+    telemetryFrame(true); // the received axes
 #endif
   }
 
-  // Switch channel
-  if (millis() - lastRecvTime > 500) {
-    chPointer ++;
-    if (chPointer >= sizeof((*NRFchannel) / sizeof(byte))) chPointer = 0;
-    radio.setChannel(NRFchannel[chPointer]);
-    payload.channel = NRFchannel[chPointer];
+  // Switch to the channel of the next frame, after the auto retransmits of a frame with a lost ACK (see hopping.h)
+  if (hopFollowDue()) {
+    payload.channel = hopChannel(hopSlot);
+    radio.setChannel(payload.channel);
+  }
+
+  analyzerUpdate(); // frame rate
+
+  // Search the signal on all channels of the hop table (every slot is used every 4 frames = 20ms)
+  if (millis() - lastRecvTime > hopSearchTimeout && millis() - lastSearchTime > 30) {
+    lastSearchTime = millis();
+    if (radioRate != RATE_250K) setRadioRate(RATE_250K); // the transmitter falls back as well
+    ackRateConfirm = RATE_250K;
+    payload.channel = hopSearch();
+    radio.setChannel(payload.channel);
   }
 
   if (millis() - lastRecvTime > 1000) { // set all analog values to their middle position, if no RC signal is received during 1s!
@@ -868,10 +1151,8 @@ void readRadio() {
     data.axis2 = 50; // Elevator
     data.axis3 = 50; // Throttle
     data.axis4 = 50; // Rudder
+    for (byte i = 0; i < 4; i++) axisFine[i] = 500;
     payload.batteryOk = true; // Clear low battery alert (allows to re-enable the vehicle, if you switch off the transmitter)
-#ifdef DEBUG
-    Serial.println("No Radio Available - Check Transmitter!");
-#endif
   }
 
   if (millis() - lastRecvTime > 2000) {
@@ -907,33 +1188,21 @@ void led() {
 
 void checkBattery() {
 
-  // Every 500 ms
-  static unsigned long lastTrigger;
-  if (millis() - lastTrigger >= 500) {
-    lastTrigger = millis();
+  // Called every 500 ms by the scheduler. Integer millivolts, the battery input is averaged by the ADC scan
 
 #if F_CPU == 16000000 // 16MHz / 5V
-    txBatt = (analogRead(BATTERY_DETECT_PIN) / 68.2) + diodeDrop; // 1023steps / 15V = 68.2 + diode drop!
+  txBatt = (uint32_t)adcReadFine(BATTERY_DETECT_PIN) * 15000 / 16368 + txProfile::diodeDropMillivolts; // 1023steps = 15V + diode drop!
 #else // 8MHz / 3.3V
-    txBatt = (analogRead(BATTERY_DETECT_PIN) / 103.33) + diodeDrop; // 1023steps / 9.9V = 103.33 + diode drop!
+  txBatt = (uint32_t)adcReadFine(BATTERY_DETECT_PIN) * 9900 / 16368 + txProfile::diodeDropMillivolts; // 1023steps = 9.9V + diode drop!
 #endif
 
-    txVcc = readVcc() / 1000.0 ;
+  txVcc = readVcc(); // measured by the ADC scan between two scans (non blocking)
 
-    if (txBatt >= cutoffVoltage) {
-      batteryOkTx = true;
-#ifdef DEBUG
-      Serial.print(txBatt);
-      Serial.println(" Tx battery OK");
-#endif
-    } else {
-      batteryOkTx = false;
-#ifdef DEBUG
-      Serial.print(txBatt);
-      Serial.println(" Tx battery empty!");
-#endif
-    }
-  }
+  // Discharge models & runtime estimation
+  batteryUpdate(txBattery, txBatt);
+  if (operationMode == 0 && transmissionMode == 1 && transmissionState && !tdmaActive) batteryUpdate(vehicleBattery, payload.batteryVoltage);
+
+  batteryOkTx = (txBatt >= txProfile::cutoffMillivolts);
 }
 
 //
@@ -942,238 +1211,514 @@ void checkBattery() {
 // =======================================================================================================
 //
 
-void drawDisplay() {
-
-  u8g.firstPage();  // clear screen
-  do {
-    switch (activeScreen) {
-      case 0: // Screen # 0 splash screen-----------------------------------
-
-        if (operationMode == 0) u8g.drawStr(3, 10, "Micro RC Transmitter");
-        if (operationMode == 1) u8g.drawStr(3, 10, "Micro RC Tester");
-        if (operationMode == 2) u8g.drawStr(3, 10, "Micro PONG");
-
-        // Dividing Line
-        u8g.drawLine(0, 13, 128, 13);
-
-        // Software version
-        u8g.setPrintPos(3, 30);
-        u8g.print("SW: ");
-        u8g.print(codeVersion);
-
-        // Hardware version
-        u8g.print(" HW: ");
-        u8g.print(boardVersion);
-
-        u8g.setPrintPos(3, 43);
-        u8g.print("created by:");
-        u8g.setPrintPos(3, 55);
-        u8g.print("TheDIYGuy999");
+// Request a display refresh (non blocking, the display task does the work) ----
+void requestDisplay() {
+  displayRequested = true;
+}
 
-        break;
+// Render and send one display page per call (called by the display task) ----
+void updateDisplay() {
 
-      case 100: // Screen # 100 diagnosis screen-----------------------------------
+  if (!displayBusy) { // Start a new frame, if requested
+    if (!displayRequested) return;
+    displayRequested = false; // requests, which are coming in during this frame are shown in the next one
+    u8g.firstPage();
+    displayBusy = true;
+  }
 
-        u8g.drawStr(3, 10, "Joystick readings:");
+  BENCH_START(BENCH_DISPLAY);
 
-        // Joysticks:
-        u8g.setPrintPos(3, 30);
-        u8g.print("Axis 1: ");
-        u8g.print(data.axis1);
-        u8g.setPrintPos(3, 40);
-        u8g.print("Axis 2: ");
-        u8g.print(data.axis2);
-        u8g.setPrintPos(3, 50);
-        u8g.print("Axis 3: ");
-        u8g.print(data.axis3);
-        u8g.setPrintPos(3, 60);
-        u8g.print("Axis 4: ");
-        u8g.print(data.axis4);
+  drawScreen();
+  if (!u8g.nextPage()) displayBusy = false; // Only changed pages are sent via I2C (see displayFilter.h)
 
-        break;
+  BENCH_STOP(BENCH_DISPLAY);
+}
 
-      case 1: // Screen # 1 main screen-------------------------------------
+// Draw an entire frame (blocking, only used during setup) ----
+void drawDisplay() {
 
-        // Tester mode ==================
-        if (operationMode == 1) {
-          // screen dividing lines ----
-          u8g.drawLine(0, 12, 128, 12);
+  u8g.firstPage();  // clear screen
+  do {
+    drawScreen();
+  } while ( u8g.nextPage() ); // show display queue
+}
 
-          // Tx: data ----
-          u8g.setPrintPos(0, 10);
-          u8g.print("CH: ");
-          u8g.print(vehicleNumber);
-          u8g.setPrintPos(50, 10);
-          u8g.print("Bat: ");
-          u8g.print(txBatt);
-          u8g.print("V");
-
-          drawTarget(0, 14, 50, 50, data.axis4, data.axis3); // left joystick
-          drawTarget(74, 14, 50, 50, data.axis1, data.axis2); // right joystick
-          drawTarget(55, 14, 14, 50, 14, data.pot1); // potentiometer
+// Draw the content of the active screen into the current page ----
+void drawScreen() {
+
+  switch (activeScreen) {
+    case 0: // Screen # 0 splash screen-----------------------------------
+
+      if (operationMode == 0) u8g.drawStr(3, 10, F("Micro RC Transmitter"));
+      if (operationMode == 1) u8g.drawStr(3, 10, F("Micro RC Tester"));
+      if (operationMode == 2) u8g.drawStr(3, 10, F("Micro PONG"));
+
+      // Dividing Line
+      u8g.drawLine(0, 13, 128, 13);
+
+      // Software version
+      u8g.setPrintPos(3, 30);
+      u8g.print(F("SW: "));
+      u8g.print(codeVersion);
+
+      // Hardware version
+      u8g.print(F(" HW: "));
+      u8g.print(txProfile::boardVersion / 10);
+      u8g.print('.');
+      u8g.print(txProfile::boardVersion % 10);
+
+      u8g.setPrintPos(3, 43);
+      u8g.print(F("created by:"));
+      u8g.setPrintPos(3, 55);
+      u8g.print(F("TheDIYGuy999"));
+
+      break;
+
+    case 2: { // Screen # 2 link analyzer (radio tester mode)-----------------------------------
+
+        u8g.setPrintPos(0, 0);
+        u8g.print(F("Analyzer "));
+        u8g.print(analyzerRate);
+        u8g.print(F(" fps"));
+
+        // Inter-arrival time (gaps excluded)
+        u8g.drawStr(0, 10, F("us   min  avg  max"));
+        u8g.setPrintPos(24, 20);
+        if (analyzerPackets > 1) u8g.print(analyzerMin);
+        u8g.setPrintPos(54, 20);
+        u8g.print(analyzerAverage());
+        u8g.setPrintPos(84, 20);
+        u8g.print(analyzerMax);
+
+        // Inter-arrival time histogram: 1ms per bar, scaled to the highest bar
+        unsigned int peak = 1;
+        for (byte i = 0; i < analyzerBins; i++) peak = max(peak, analyzerInterval[i]);
+        for (byte i = 0; i < analyzerBins; i++) {
+          byte height = (unsigned long)analyzerInterval[i] * 20 / peak;
+          u8g.drawBox(i * 8, 52 - height, 6, height);
         }
 
-        // Transmitter mode ================
-        if (operationMode == 0) {
-          // screen dividing lines ----
-          u8g.drawLine(0, 13, 128, 13);
-          u8g.drawLine(64, 0, 64, 64);
-
-          // Tx: data ----
-          u8g.setPrintPos(0, 10);
-          if (transmissionMode > 1) {
-            u8g.print("Tx: IR   ");
-            if (transmissionMode < 3) u8g.print(pfChannel + 1);
-
-            u8g.setPrintPos(68, 10);
-            if (transmissionMode == 2) u8g.print("LEGO");
-            if (transmissionMode == 3) u8g.print("MECCANO");
-          }
-          else {
-            u8g.print("Tx: 2.4G");
-            u8g.setPrintPos(52, 10);
-            u8g.print(vehicleNumber);
-          }
-
-          u8g.setPrintPos(3, 25);
-          u8g.print("Vcc: ");
-          u8g.print(txVcc);
+        // Lost frames & gaps
+        unsigned int gaps = 0;
+        for (byte i = 0; i < analyzerGapBins; i++) gaps += analyzerGaps[i];
+        u8g.setPrintPos(0, 54);
+        u8g.print(F("Lost "));
+        u8g.print(analyzerLost);
+        u8g.print(F(" Gaps "));
+        u8g.print(gaps);
+      }
+      break;
+
+    case 3: // Screen # 3 quick trim (long press on "SEL")-----------------------------------
+
+      u8g.drawStr(0, 0, F("Quick trim"));
+      u8g.drawLine(0, 11, 128, 11);
+
+      // Trim of every axis in %, the selected one is marked
+      for (byte i = 0; i < 4; i++) {
+        byte y = i * 12 + 15;
+        if (i == trimAxis) u8g.drawStr(0, y, F(">"));
+        u8g.setPrintPos(12, y);
+        u8g.print(F("CH"));
+        u8g.print(i + 1);
+        u8g.setPrintPos(60, y);
+        if (quickTrim[i] > 0) u8g.print(F("+"));
+        u8g.print(quickTrim[i] / 10.0, 1);
+        u8g.print(F("%"));
+      }
+      break;
 
-          u8g.setPrintPos(3, 35);
-          u8g.print("Bat: ");
-          u8g.print(txBatt);
+    case 13: { // Screen # 13 vehicle discovery -----------------------------------
 
-          // Rx: data. Only display the following content, if in radio mode ----
-          if (transmissionMode == 1) {
-            u8g.setPrintPos(68, 10);
-            if (transmissionState) {
-              u8g.print("Rx: OK");
-            }
-            else {
-              u8g.print("Rx: ??");
-            }
+        u8g.setPrintPos(0, 0);
+        u8g.print(F("Discovery  ch "));
+        u8g.print(hopTable[(discoverySweep >> 1) & (hopSlots - 1)][discoverySweep & 1]);
 
-            u8g.setPrintPos(3, 45);
-            u8g.print("Mode 1: ");
-            u8g.print(data.mode1);
-
-            u8g.setPrintPos(3, 55);
-            u8g.print("Mode 2: ");
-            u8g.print(data.mode2);
-
-            if (transmissionState) {
-              u8g.setPrintPos(68, 25);
-              u8g.print("Vcc: ");
-              u8g.print(payload.vcc);
-
-              u8g.setPrintPos(68, 35);
-              u8g.print("Bat: ");
-              u8g.print(payload.batteryVoltage);
-
-              u8g.setPrintPos(68, 45);
-              if (payload.batteryOk) {
-                u8g.print("Bat. OK ");
-              }
-              else {
-                u8g.print("Low Bat. ");
-              }
-              u8g.setPrintPos(68, 55);
-              u8g.print("CH: ");
-              u8g.print(payload.channel);
-            }
+        // Found vehicles & battery voltage, 2 columns with 5 rows (the page with the cursor is displayed)
+        byte found = 0;
+        byte page = 0;
+        for (byte i = 0; i < maxVehicleNumber; i++) {
+          if (!discoveryFound(i)) continue;
+          if (i == discoveryCursor) page = found / 10;
+          found ++;
+        }
+        if (found == 0) u8g.drawStr(0, 12, F("Searching..."));
+
+        byte entry = 0;
+        for (byte i = 0; i < maxVehicleNumber; i++) {
+          if (!discoveryFound(i)) continue;
+          if (entry / 10 == page) {
+            byte x = (entry % 10) / 5 * 64;
+            byte y = (entry % 5) * 10 + 12;
+            if (i == discoveryCursor) u8g.drawStr(x, y, F(">"));
+            u8g.setPrintPos(x + 6, y);
+            u8g.print(i + 1);
+            if (bitRead(tdmaGroup, i)) u8g.drawStr(x + 18, y, F("*")); // member of the group
+            u8g.setPrintPos(x + 24, y);
+            u8g.print(discoveryBattery[i] / 1000.0);
+            u8g.print(F("V"));
           }
+          entry ++;
         }
+      }
+      break;
+
+    case 100: { // Screen # 100 diagnosis screen-----------------------------------
+
+        u8g.drawStr(0, 0, F("Task  runs wcet jit"));
+
+        // Task statistics (execution time & start jitter in us), only the active ones:
+        byte row = 9;
+        for (byte i = 0; i < TASK_COUNT; i++) {
+          if (!tasks[i].enabled) continue;
+          u8g.setPrintPos(0, row);
+          u8g.print(tasks[i].name);
+          u8g.setPrintPos(28, row);
+          u8g.print(tasks[i].runs);
+          u8g.setPrintPos(74, row);
+          u8g.print(tasks[i].wcet);
+          u8g.setPrintPos(104, row);
+          u8g.print(tasks[i].jitter);
+          row += 8;
+        }
+      }
+      break;
+
+    case 101: // Screen # 101 link diagnostics screen-----------------------------------
+
+      // Data rate & PA level
+      u8g.setPrintPos(0, 0);
+      if (radioRate == RATE_250K) u8g.print(F("250k"));
+      if (radioRate == RATE_1M) u8g.print(F("1M"));
+      if (radioRate == RATE_2M) u8g.print(F("2M"));
+      u8g.print(F(" P"));
+      u8g.print(min(linkLevels[linkLevelNow].pa, paLimit));
+      u8g.drawStr(48, 0, F("sent ACK loss"));
+      u8g.setPrintPos(0, 10);
+      u8g.print(F("per s "));
+      u8g.setPrintPos(48, 10);
+      u8g.print(linkStats.sentPerSecond);
+      u8g.setPrintPos(78, 10);
+      u8g.print(linkStats.ackedPerSecond);
+      u8g.setPrintPos(102, 10);
+      u8g.print(linkStats.loss);
+      u8g.print(F("%"));
+
+      // Average auto retransmits & lost ACKs
+      u8g.setPrintPos(0, 20);
+      u8g.print(F("Retr "));
+      u8g.print(linkStats.retries / 10);
+      u8g.print(F("."));
+      u8g.print(linkStats.retries % 10);
+      u8g.print(F(" ACK lost "));
+      u8g.print(linkStats.ackLost);
+
+      // Round trip time percentiles
+      u8g.drawStr(0, 30, F("RTT us  50% 90%  max"));
+      u8g.setPrintPos(42, 40);
+      u8g.print(linkStats.rtt50);
+      u8g.setPrintPos(72, 40);
+      u8g.print(linkStats.rtt90);
+      u8g.setPrintPos(102, 40);
+      u8g.print(linkStats.rttMax);
+
+      // Link quality of the active channel in each hop slot
+      u8g.setPrintPos(0, 52);
+      u8g.print(F("Q:"));
+      for (byte i = 0; i < hopSlots; i++) {
+        u8g.print(F(" "));
+        u8g.print(hopStats[i][(hopMask >> i) & 1].quality);
+      }
+      break;
+
+    case 102: // Screen # 102 memory diagnostics screen-----------------------------------
+
+      u8g.drawStr(0, 0, F("RAM usage (bytes)"));
+      u8g.drawStr(0, 15, F("Static:"));
+      u8g.setPrintPos(80, 15);
+      u8g.print(memory.staticRam);
+      u8g.drawStr(0, 27, F("Stack max.:"));
+      u8g.setPrintPos(80, 27);
+      u8g.print(memory.stackMax);
+      u8g.drawStr(0, 39, F("Never used:"));
+      u8g.setPrintPos(80, 39);
+      u8g.print(memory.headroom);
+      u8g.drawStr(0, 51, F("Total:"));
+      u8g.setPrintPos(80, 51);
+      u8g.print(memory.staticRam + memory.stackMax + memory.headroom); // 2048 @ ATmega328
+      break;
+
+    case 103: // Screen # 103 battery diagnostics screen-----------------------------------
+
+      u8g.drawStr(0, 0, F("Battery     Tx  Veh."));
+      u8g.drawStr(0, 15, F("Volt:"));
+      u8g.setPrintPos(60, 15);
+      u8g.print(txBattery.millivolts / 1000.0);
+      u8g.setPrintPos(96, 15);
+      u8g.print(vehicleBattery.millivolts / 1000.0);
+      u8g.drawStr(0, 27, F("Cells:"));
+      u8g.setPrintPos(72, 27);
+      u8g.print(txBattery.cells);
+      u8g.setPrintPos(108, 27);
+      u8g.print(vehicleBattery.cells);
+      u8g.drawStr(0, 39, F("Charge %:"));
+      u8g.setPrintPos(66, 39);
+      u8g.print(txBattery.soc);
+      u8g.setPrintPos(102, 39);
+      u8g.print(vehicleBattery.soc);
+      u8g.drawStr(0, 51, F("Runtime:"));
+      u8g.setPrintPos(60, 51);
+      printRuntime(txBattery.runtime);
+      u8g.setPrintPos(96, 51);
+      printRuntime(vehicleBattery.runtime);
+      break;
+
+    case 104: // Screen # 104 power diagnostics screen-----------------------------------
+
+      u8g.drawStr(0, 0, F("Power:"));
+      u8g.setPrintPos(42, 0);
+      if (powerState == POWER_ACTIVE) u8g.print(F("active"));
+      else u8g.print(F("idle"));
+      u8g.drawStr(0, 11, F("Frames/s:"));
+      u8g.setPrintPos(80, 11);
+      u8g.print(power.framesPerSecond);
+      u8g.drawStr(0, 22, F("CPU sleep %:"));
+      u8g.setPrintPos(80, 22);
+      u8g.print(power.sleep);
+      u8g.drawStr(0, 33, F("Latency us avg  max"));
+      u8g.drawStr(0, 43, F("active"));
+      u8g.setPrintPos(60, 43);
+      u8g.print(power.latencyAvg[POWER_ACTIVE]);
+      u8g.setPrintPos(96, 43);
+      u8g.print(power.latencyMax[POWER_ACTIVE]);
+      u8g.drawStr(0, 53, F("idle"));
+      u8g.setPrintPos(60, 53);
+      u8g.print(power.latencyAvg[POWER_IDLE]);
+      u8g.setPrintPos(96, 53);
+      u8g.print(power.latencyMax[POWER_IDLE]);
+      break;
+
+    case 1: // Screen # 1 main screen-------------------------------------
+
+      // Game mode ==================
+      if (operationMode == 2) pongDraw(); // the snapshot of the game
+
+      // Tester mode ==================
+      if (operationMode == 1) {
+        // screen dividing lines ----
+        u8g.drawLine(0, 12, 128, 12);
+
+        // Tx: data ----
+        u8g.setPrintPos(0, 10);
+        u8g.print(F("CH: "));
+        u8g.print(vehicleNumber);
+        u8g.setPrintPos(50, 10);
+        u8g.print(F("Bat: "));
+        u8g.print(txBatt / 1000.0);
+        u8g.print(F("V"));
+
+        drawTarget(0, 14, 50, 50, data.axis4, data.axis3); // left joystick
+        drawTarget(74, 14, 50, 50, data.axis1, data.axis2); // right joystick
+        drawTarget(55, 14, 14, 50, 14, data.pot1); // potentiometer
+      }
 
-        // Game mode ================
-        // called directly inside the loop() function to increase speed!
-
-        break;
+      // Transmitter mode, group of vehicles (TDMA) ================
+      if (operationMode == 0 && tdmaActive) {
+        u8g.drawLine(0, 11, 128, 11);
+
+        // Frame budget: frames per second for every vehicle ----
+        u8g.setPrintPos(0, 0);
+        u8g.print(F("TDMA "));
+        u8g.print(tdmaCount);
+        u8g.print(F(" x "));
+        u8g.print(tdmaFrameRate / tdmaCount);
+        u8g.print(F("Hz"));
+
+        // Vehicle: achieved update rate in Hz & battery voltage ("!" = low battery), 2 columns with 4 rows ----
+        for (byte i = 0; i < tdmaCount; i++) {
+          u8g.setPrintPos(i / 4 * 64, i % 4 * 12 + 15);
+          u8g.print(tdmaVehicle[i]);
+          u8g.print(F(":"));
+          u8g.print(tdmaStats[i].rate);
+          u8g.print(F(" "));
+          u8g.print(tdmaStats[i].payload.batteryVoltage / 1000.0, 1);
+          if (tdmaStats[i].payload.batteryOk) u8g.print(F("V"));
+          else u8g.print(F("!"));
+        }
+      }
 
-      case 11: // Screen # 11 Menu 1 (channel reversing)-----------------------------------
+      // Transmitter mode ================
+      if (operationMode == 0 && !tdmaActive) {
+        // screen dividing lines ----
+        u8g.drawLine(0, 13, 128, 13);
+        u8g.drawLine(64, 0, 64, 64);
 
+        // Tx: data ----
         u8g.setPrintPos(0, 10);
-        u8g.print("Channel Reverse (");
-        u8g.print(vehicleNumber);
-        u8g.print(")");
+        if (transmissionMode > 1) {
+          u8g.print(F("Tx: IR   "));
+          if (transmissionMode < 3) u8g.print(pfChannel + 1);
 
-        // Dividing Line
-        u8g.drawLine(0, 13, 128, 13);
+          u8g.setPrintPos(68, 10);
+          if (transmissionMode == 2) u8g.print(F("LEGO"));
+          if (transmissionMode == 3) u8g.print(F("MECCANO"));
+        }
+        else {
+          u8g.print(F("Tx: 2.4G"));
+          u8g.setPrintPos(52, 10);
+          u8g.print(vehicleNumber);
+        }
 
-        // Cursor
-        if (menuRow == 1) u8g.setPrintPos(0, 25);
-        if (menuRow == 2) u8g.setPrintPos(0, 35);
-        if (menuRow == 3) u8g.setPrintPos(0, 45);
-        if (menuRow == 4) u8g.setPrintPos(0, 55);
-        u8g.print(">");
+        u8g.setPrintPos(3, 25);
+        u8g.print(F("Vcc: "));
+        u8g.print(txVcc / 1000.0);
 
-        // Servos
-        u8g.setPrintPos(10, 25);
-        u8g.print("CH. 1 (R -): ");
-        u8g.print(joystickReversed[vehicleNumber][0]); // 0 = Channel 1 etc.
+        u8g.setPrintPos(3, 35);
+        u8g.print(F("Bat: "));
+        u8g.print(txBatt / 1000.0);
 
-        u8g.setPrintPos(10, 35);
-        u8g.print("CH. 2 (R |): ");
-        u8g.print(joystickReversed[vehicleNumber][1]);
+        // Rx: data. Only display the following content, if in radio mode ----
+        if (transmissionMode == 1) {
+          u8g.setPrintPos(68, 10);
+          if (transmissionState) {
+            u8g.print(F("Rx: OK"));
+          }
+          else {
+            u8g.print(F("Rx: ??"));
+          }
 
-        u8g.setPrintPos(10, 45);
-        u8g.print("CH. 3 (L |): ");
-        u8g.print(joystickReversed[vehicleNumber][2]);
+          u8g.setPrintPos(3, 45);
+          u8g.print(F("Mode 1: "));
+          u8g.print(data.mode1);
 
-        u8g.setPrintPos(10, 55);
-        u8g.print("CH. 4 (L -): ");
-        u8g.print(joystickReversed[vehicleNumber][3]);
+          u8g.setPrintPos(3, 55);
+          u8g.print(F("Mode 2: "));
+          u8g.print(data.mode2);
 
-        break;
+          if (transmissionState) {
+            u8g.setPrintPos(68, 25);
+            u8g.print(F("Vcc: "));
+            u8g.print(payload.vcc / 1000.0);
 
-      case 12: // Screen # 12 Menu 2 (channel travel limitation)-----------------------------------
+            u8g.setPrintPos(68, 35);
+            u8g.print(F("Bat: "));
+            u8g.print(payload.batteryVoltage / 1000.0);
 
-        u8g.setPrintPos(0, 10);
-        u8g.print("Channel % - & + (");
-        u8g.print(vehicleNumber);
-        u8g.print(")");
+            u8g.setPrintPos(68, 45);
+            if (payload.batteryOk) {
+              u8g.print(F("Bat. OK "));
+            }
+            else {
+              u8g.print(F("Low Bat. "));
+            }
+            u8g.setPrintPos(68, 55);
+            u8g.print(F("CH: "));
+            u8g.print(payload.channel);
+          }
+        }
+      }
 
-        // Dividing Line
-        u8g.drawLine(0, 13, 128, 13);
+      // Game mode ================
+      // called directly inside the loop() function to increase speed!
+
+      break;
+
+    case 11: // Screen # 11 Menu 1 (channel reversing)-----------------------------------
+
+      u8g.setPrintPos(0, 10);
+      u8g.print(F("Channel Reverse ("));
+      u8g.print(vehicleNumber);
+      u8g.print(F(")"));
+
+      // Dividing Line
+      u8g.drawLine(0, 13, 128, 13);
+
+      // Cursor
+      if (menuRow == 1) u8g.setPrintPos(0, 25);
+      if (menuRow == 2) u8g.setPrintPos(0, 35);
+      if (menuRow == 3) u8g.setPrintPos(0, 45);
+      if (menuRow == 4) u8g.setPrintPos(0, 55);
+      u8g.print(F(">"));
+
+      // Servos
+      u8g.setPrintPos(10, 25);
+      u8g.print(F("CH. 1 (R -): "));
+      u8g.print(bitRead(settings.reversed, 0)); // 0 = Channel 1 etc.
+
+      u8g.setPrintPos(10, 35);
+      u8g.print(F("CH. 2 (R |): "));
+      u8g.print(bitRead(settings.reversed, 1));
+
+      u8g.setPrintPos(10, 45);
+      u8g.print(F("CH. 3 (L |): "));
+      u8g.print(bitRead(settings.reversed, 2));
+
+      u8g.setPrintPos(10, 55);
+      u8g.print(F("CH. 4 (L -): "));
+      u8g.print(bitRead(settings.reversed, 3));
+
+      break;
+
+    case 12: // Screen # 12 Menu 2 (channel travel limitation)-----------------------------------
+
+      u8g.setPrintPos(0, 10);
+      u8g.print(F("Channel % - & + ("));
+      u8g.print(vehicleNumber);
+      u8g.print(F(")"));
+
+      // Dividing Line
+      u8g.drawLine(0, 13, 128, 13);
+
+      // Cursor
+      if (menuRow == 5) u8g.setPrintPos(45, 25);
+      if (menuRow == 6) u8g.setPrintPos(90, 25);
+      if (menuRow == 7) u8g.setPrintPos(45, 35);
+      if (menuRow == 8) u8g.setPrintPos(90, 35);
+      if (menuRow == 9) u8g.setPrintPos(45, 45);
+      if (menuRow == 10) u8g.setPrintPos(90, 45);
+      if (menuRow == 11) u8g.setPrintPos(45, 55);
+      if (menuRow == 12) u8g.setPrintPos(90, 55);
+      u8g.print(F(">"));
+
+      // Servo travel percentage
+      u8g.setPrintPos(0, 25);
+      u8g.print(F("CH. 1:   "));
+      u8g.print(settings.percentNegative[0]); // 0 = Channel 1 etc.
+      u8g.setPrintPos(100, 25);
+      u8g.print(settings.percentPositive[0]);
+
+      u8g.setPrintPos(0, 35);
+      u8g.print(F("CH. 2:   "));
+      u8g.print(settings.percentNegative[1]);
+      u8g.setPrintPos(100, 35);
+      u8g.print(settings.percentPositive[1]);
+
+      u8g.setPrintPos(0, 45);
+      u8g.print(F("CH. 3:   "));
+      u8g.print(settings.percentNegative[2]);
+      u8g.setPrintPos(100, 45);
+      u8g.print(settings.percentPositive[2]);
+
+      u8g.setPrintPos(0, 55);
+      u8g.print(F("CH. 4:   "));
+      u8g.print(settings.percentNegative[3]);
+      u8g.setPrintPos(100, 55);
+      u8g.print(settings.percentPositive[3]);
+
+      break;
+  }
+}
 
-        // Cursor
-        if (menuRow == 5) u8g.setPrintPos(45, 25);
-        if (menuRow == 6) u8g.setPrintPos(90, 25);
-        if (menuRow == 7) u8g.setPrintPos(45, 35);
-        if (menuRow == 8) u8g.setPrintPos(90, 35);
-        if (menuRow == 9) u8g.setPrintPos(45, 45);
-        if (menuRow == 10) u8g.setPrintPos(90, 45);
-        if (menuRow == 11) u8g.setPrintPos(45, 55);
-        if (menuRow == 12) u8g.setPrintPos(90, 55);
-        u8g.print(">");
-
-        // Servo travel percentage
-        u8g.setPrintPos(0, 25);
-        u8g.print("CH. 1:   ");
-        u8g.print(joystickPercentNegative[vehicleNumber][0]); // 0 = Channel 1 etc.
-        u8g.setPrintPos(100, 25);
-        u8g.print(joystickPercentPositive[vehicleNumber][0]);
-
-        u8g.setPrintPos(0, 35);
-        u8g.print("CH. 2:   ");
-        u8g.print(joystickPercentNegative[vehicleNumber][1]);
-        u8g.setPrintPos(100, 35);
-        u8g.print(joystickPercentPositive[vehicleNumber][1]);
-
-        u8g.setPrintPos(0, 45);
-        u8g.print("CH. 3:   ");
-        u8g.print(joystickPercentNegative[vehicleNumber][2]);
-        u8g.setPrintPos(100, 45);
-        u8g.print(joystickPercentPositive[vehicleNumber][2]);
-
-        u8g.setPrintPos(0, 55);
-        u8g.print("CH. 4:   ");
-        u8g.print(joystickPercentNegative[vehicleNumber][3]);
-        u8g.setPrintPos(100, 55);
-        u8g.print(joystickPercentPositive[vehicleNumber][3]);
-
-        break;
-    }
-  } while ( u8g.nextPage() ); // show display queue
+// Runtime in hours & minutes ----
+void printRuntime(unsigned int minutes) {
+  if (minutes == batteryUnknown) {
+    u8g.print(F("--"));
+    return;
+  }
+  u8g.print(minutes / 60);
+  u8g.print(F("h"));
+  if (minutes % 60 < 10) u8g.print(F("0"));
+  u8g.print(minutes % 60);
 }
 
 // Draw target subfunction for radio tester mode ----
@@ -1184,11 +1729,12 @@ void drawTarget(int x, int y, int w, int h, int posX, int posY) {
 
 //
 // =======================================================================================================
-// MAIN LOOP
+// TASKS
 // =======================================================================================================
 //
 
-void loop() {
+// Control path task: sample, map and transmit with a constant frame rate ----
+void controlTask() {
 
   // only read analog inputs in transmitter (0) or game mode (2)
   if (operationMode == 0 || operationMode == 2) {
@@ -1198,30 +1744,76 @@ void loop() {
 
     // Read Potentiometer
     readPotentiometer();
+
+#ifdef RECORDER
+    if (operationMode == 0) replayInputs(); // the recorded inputs are replacing the joysticks during a replay
+#endif
   }
 
-  // Transmit data via infrared or 2.4GHz radio
-  if (operationMode == 1) readRadio(); // 2.4 GHz radio tester
+  // Transmit data via infrared or 2.4GHz radio (the 2.4 GHz radio tester is running in the radio task)
   if (operationMode == 0) {
-    transmitRadio(); // 2.4 GHz radio
+    powerUpdate(); // frame rate, sleep ratio & latency, every second
+    if (!discoveryActive) transmitRadio(); // 2.4 GHz radio (the radio is used by the discovery scan otherwise)
     if (transmissionMode == 2) transmitLegoIr(); // LEGO Infrared
     if (transmissionMode == 3) transmitMeccanoIr(); // MECCANO Infrared
   }
 
-  // Refresh display every 200 ms in tester mode (otherwise only, if value has changed)
-  static unsigned long lastDisplay;
-  if (operationMode == 1 && millis() - lastDisplay >= 200) {
-    lastDisplay = millis();
-    drawDisplay();
+#ifdef RECORDER
+  recorderUpdate(); // send the records, receive the replay
+#endif
+#ifdef TELEMETRY
+  telemetryUpdate(tasks[TASK_CONTROL]); // link, battery & timing records
+#endif
+}
+
+// Display task: one page per call. Refresh every 200ms in tester mode, on the discovery and the diagnostics screens, as fast as possible in game mode, otherwise only, if requested ----
+void displayTask() {
+  static unsigned long lastRefresh;
+  if (operationMode == 2 && pongFrameDue()) requestDisplay();
+  if ((operationMode == 1 || activeScreen == 13 || activeScreen >= 100) && millis() - lastRefresh >= 200) {
+    lastRefresh = millis();
+    if (activeScreen == 102) measureMemory();
+    requestDisplay();
   }
+  updateDisplay();
+}
 
-  // Atari Pong game :-)
-  if (operationMode == 2) pong();
+// Task table setup ----
+void setupTasks() {
+  boolean game = (operationMode == 2);
+
+  // Task, name, function, period in us (0 = background), enabled
+  setTask(tasks[TASK_CONTROL], F("Ctrl"), controlTask, 5000, true); // 200Hz frame rate
+  setTask(tasks[TASK_BUTTONS], F("Btn"), readButtons, 10000, !game);
+  setTask(tasks[TASK_LED], F("LED"), led, 10000, !game);
+  setTask(tasks[TASK_BATTERY], F("Batt"), checkBattery, 500000, !game);
+  setTask(tasks[TASK_DISPLAY], F("Disp"), displayTask, game ? 5000 : 10000, true); // one page = 8 rows per call (game: 25 frames per second)
+  setTask(tasks[TASK_SETTINGS], F("EEP"), settingsTask, 10000, !game); // one byte per call (3.3ms write time)
+  setTask(tasks[TASK_PONG], F("Pong"), pong, 0, game); // Atari Pong game :-) physics with a fixed timestep
+  setTask(tasks[TASK_RADIO], F("Radio"), (operationMode == 1) ? readRadio : pollRadio, 0, operationMode <= 1); // only one background task can be active!
+
+  startScheduler(tasks, TASK_COUNT);
+}
 
-  // If not in game mode:
-  else {
-    led(); // LED control
-    checkBattery(); // Check battery
-    readButtons();
-  }
+//
+// =======================================================================================================
+// MAIN LOOP
+// =======================================================================================================
+//
+
+void loop() {
+
+  BENCH_START(BENCH_LOOP);
+
+  // Execute the next due task. The control path has the highest priority, housekeeping fills the remaining time
+  runScheduler(tasks, TASK_COUNT);
+
+  BENCH_STOP(BENCH_LOOP);
+
+  // Sleep until the next interrupt, if there is nothing to do (transmitter mode only, no frame in the air)
+  if (operationMode == 0 && !txBusy && !discoveryActive && !schedulerDue(tasks, TASK_COUNT)) powerSleep();
+
+#ifdef BENCHMARK
+  benchmarkReport(); // Print the execution times (not included in the loop() measurement)
+#endif
 }
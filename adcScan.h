@@ -0,0 +1,163 @@
+/*
+  Free running, interrupt driven ADC scan engine for the "Micro RC" transmitter (AVR only)
+  A0 - A3 (joysticks), A6 (potentiometer) and A7 (battery) are scanned continuously in the background.
+  Each channel is oversampled and IIR filtered. The results of the last complete scan are stored in a
+  double buffer, so adcRead() never waits for a conversion.
+  The internal 1.1V reference is measured between two scans (every 64th scan), so the Vcc measurement never
+  takes time from a joystick reading.
+  Created by TheDIYGuy999
+*/
+
+#ifndef adcScan_h
+#define adcScan_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// ADC SCAN SETTINGS & VARIABLES
+// =======================================================================================================
+//
+
+const byte adcChannels[] = {0, 1, 2, 3, 6, 7}; // ADC multiplexer channels (A0, A1, A2, A3, A6, A7)
+const byte adcChannelCount = sizeof(adcChannels);
+const byte adcIndex[8] = {0, 1, 2, 3, 255, 255, 4, 5}; // Analog pin number (A0 = 0) to scan index. A4 & A5 = I2C!
+
+const byte adcOversamplingShift = 2; // 2^2 = 4 samples per channel and scan (max. 4)
+
+// IIR filter per channel (A0, A1, A2, A3, A6, A7): 0 = off, n = new sample is weighted with 1 / 2^n
+const byte adcFilter[adcChannelCount] = {1, 1, 1, 1, 2, 4};
+
+// Vcc measurement: the 1.1V reference is measured against AVcc (ATmega328 only)
+const byte adcVccChannel = 0x0E; // multiplexer setting for the internal 1.1V reference
+const byte adcVccInterval = 64; // the Vcc slot is inserted after every 64th scan (about every 0.3s)
+const byte adcVccSettle = 5; // conversions, which are discarded, until the reference is settled (5 x 104us = 0.52ms, min. 0.5ms)
+
+// Results in 1/16 LSB (0 - 16368), double buffered
+volatile uint16_t adcBuffer[2][adcChannelCount];
+volatile byte adcReadBuffer = 0; // the buffer with the last complete scan
+volatile unsigned long adcScanMicros; // micros() at the end of the last complete scan
+uint16_t adcFiltered[adcChannelCount]; // filter state (interrupt only)
+
+volatile uint16_t adcVcc = 0; // 1.1V reference in 1/16 LSB (0 = not yet measured)
+
+byte adcChannel = 0; // the channel, which is converted now, adcChannelCount = Vcc slot (interrupt only)
+byte adcScans = adcVccInterval - 1; // complete scans since the last Vcc slot (the first one follows the first scan)
+byte adcSettle = 0; // conversions, which are discarded (interrupt only)
+volatile boolean adcDiscard = false; // the next conversion is invalid (first conversion after adcScanStart())
+boolean adcSeeded = false; // the filters are initialized with the first sample
+
+//
+// =======================================================================================================
+// ADC CONVERSION COMPLETE INTERRUPT
+// =======================================================================================================
+//
+
+ISR(ADC_vect) {
+  static byte count;
+  static uint16_t sum;
+
+  uint16_t sample = ADC;
+
+  if (adcDiscard) adcDiscard = false;
+  else if (adcSettle > 0) adcSettle --;
+  else {
+    sum += sample;
+    count ++;
+  }
+
+  if (count >= (1 << adcOversamplingShift)) { // this channel is complete
+    uint16_t value = sum << (4 - adcOversamplingShift); // 1/16 LSB
+
+    if (adcChannel < adcChannelCount) {
+      if (!adcSeeded) adcFiltered[adcChannel] = value;
+      else adcFiltered[adcChannel] += (int16_t)(value - adcFiltered[adcChannel]) >> adcFilter[adcChannel];
+
+      adcBuffer[adcReadBuffer ^ 1][adcChannel] = adcFiltered[adcChannel];
+    }
+    else { // Vcc slot
+      if (adcVcc == 0) adcVcc = value;
+      else adcVcc += (int16_t)(value - adcVcc) >> 2;
+    }
+    sum = 0;
+    count = 0;
+
+    // Next channel
+    adcChannel ++;
+    if (adcChannel == adcChannelCount) { // scan complete, swap the buffers
+      adcSeeded = true;
+      adcReadBuffer ^= 1;
+      adcScanMicros = micros();
+      if (++adcScans >= adcVccInterval) { // Vcc slot between this and the next scan
+        adcScans = 0;
+        adcSettle = adcVccSettle;
+      }
+      else adcChannel = 0;
+    }
+    else if (adcChannel > adcChannelCount) adcChannel = 0; // Vcc slot complete
+
+    // AVcc reference. The multiplexer is switched between two conversions, so the next one is valid for the analog
+    // pins. Only the 1.1V reference needs more time: it's covered by the discarded conversions (adcSettle), not adcDiscard
+    if (adcChannel < adcChannelCount) ADMUX = _BV(REFS0) | adcChannels[adcChannel];
+    else ADMUX = _BV(REFS0) | adcVccChannel;
+  }
+
+  ADCSRA |= _BV(ADSC); // start the next conversion
+}
+
+//
+// =======================================================================================================
+// START & STOP THE SCAN
+// =======================================================================================================
+//
+
+void adcScanStart() {
+  ADMUX = _BV(REFS0) | adcChannels[adcChannel];
+  adcDiscard = true; // the first conversion after a multiplexer change is not reliable
+  ADCSRA |= _BV(ADEN) | _BV(ADIF) | _BV(ADIE); // the ADC prescaler is already set by the Arduino core
+  ADCSRA |= _BV(ADSC);
+}
+
+// Setup: start the scan and wait, until all channels are valid ----
+void setupAdcScan() {
+  adcScanStart();
+  delay(10);
+}
+
+//
+// =======================================================================================================
+// READ THE LATEST VALUE (non blocking)
+// =======================================================================================================
+//
+
+// 1/16 LSB resolution (0 - 16368) ----
+uint16_t adcReadFine(byte pin) {
+  byte i = adcIndex[(pin - A0) & 0x07];
+  if (i == 255) return 0;
+  return adcBuffer[adcReadBuffer][i]; // no lock required: the interrupt is writing into the other buffer
+}
+
+// 10 bit resolution, same range as analogRead() ----
+int adcRead(byte pin) {
+  return (adcReadFine(pin) + 8) >> 4;
+}
+
+// Time stamp of the last complete scan (micros()) ----
+unsigned long adcScanTime() {
+  uint8_t oldSREG = SREG; // 32 bit value, written by the interrupt
+  cli();
+  unsigned long value = adcScanMicros;
+  SREG = oldSREG;
+  return value;
+}
+
+// The 1.1V reference in 1/16 LSB (0 = not yet measured) ----
+uint16_t adcReadVcc() {
+  uint8_t oldSREG = SREG; // 16 bit value, written by the interrupt
+  cli();
+  uint16_t value = adcVcc;
+  SREG = oldSREG;
+  return value;
+}
+
+#endif
@@ -0,0 +1,179 @@
+/*
+  Link analyzer for the radio tester mode of the "Micro RC" transmitter
+  Every received frame is time stamped with micros(). Histograms of the inter-arrival time and of the gaps (no frame
+  for more than 20ms), the frame rate, lost frames (packed protocol sequence numbers) and the frames per channel are
+  recorded. Shown on the analyzer screen and exported via Serial as CSV.
+  Created by TheDIYGuy999
+*/
+
+#ifndef analyzer_h
+#define analyzer_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// ANALYZER VARIABLES
+// =======================================================================================================
+//
+
+const byte analyzerBins = 16; // inter-arrival time histogram: 1ms per bin, the last one is 15ms and more
+const byte analyzerGapBins = 6;
+const unsigned int analyzerGapLimits[analyzerGapBins] = {20, 50, 100, 200, 500, 1000}; // gap histogram: ms (lower limit)
+const byte analyzerChannels = hopSlots * 2 + 1; // hop table channels & others
+
+unsigned int analyzerInterval[analyzerBins];
+unsigned int analyzerGaps[analyzerGapBins];
+unsigned int analyzerChannel[analyzerChannels];
+
+unsigned long analyzerPackets; // received frames
+unsigned int analyzerLost; // lost frames (packed protocol only)
+unsigned long analyzerLast; // micros() of the previous frame
+unsigned long analyzerMin = 0xFFFFFFFF, analyzerMax, analyzerSum; // inter-arrival time in us (gaps excluded)
+unsigned int analyzerRate; // frames per second
+unsigned int analyzerSecond; // frames during the current second
+byte analyzerSequence; // sequence number of the previous frame
+
+//
+// =======================================================================================================
+// RESET THE ANALYZER
+// =======================================================================================================
+//
+
+void analyzerReset() {
+  memset(analyzerInterval, 0, sizeof(analyzerInterval));
+  memset(analyzerGaps, 0, sizeof(analyzerGaps));
+  memset(analyzerChannel, 0, sizeof(analyzerChannel));
+  analyzerPackets = 0;
+  analyzerLost = 0;
+  analyzerMin = 0xFFFFFFFF;
+  analyzerMax = 0;
+  analyzerSum = 0;
+}
+
+//
+// =======================================================================================================
+// RECORD A RECEIVED FRAME (call it for every frame, as soon as possible after the reception)
+// =======================================================================================================
+//
+
+void analyzerRecord(unsigned long timestamp, byte channel, boolean packed, byte sequence) {
+
+  // Inter-arrival time & gaps ----
+  if (analyzerPackets > 0) {
+    unsigned long interval = timestamp - analyzerLast;
+    unsigned long ms = interval / 1000;
+
+    if (ms >= analyzerGapLimits[0]) { // gap
+      byte i = analyzerGapBins - 1;
+      while (ms < analyzerGapLimits[i]) i--;
+      analyzerGaps[i] ++;
+    }
+    else {
+      if (interval < analyzerMin) analyzerMin = interval;
+      if (interval > analyzerMax) analyzerMax = interval;
+      analyzerSum += interval;
+    }
+    analyzerInterval[min(ms, (unsigned long)analyzerBins - 1)] ++;
+
+    // Lost frames: the sequence number has to be incremented by one
+    if (packed) analyzerLost += (sequence - analyzerSequence - 1) & 0x0F;
+  }
+  analyzerLast = timestamp;
+  analyzerSequence = sequence;
+  analyzerPackets ++;
+  analyzerSecond ++;
+
+  // Frames per channel ----
+  byte i = 0;
+  while (i < analyzerChannels - 1 && hopTable[i >> 1][i & 1] != channel) i++;
+  analyzerChannel[i] ++;
+}
+
+// Frame rate (call it regularly) ----
+void analyzerUpdate() {
+  static unsigned long lastSecond;
+  if (millis() - lastSecond >= 1000) {
+    lastSecond = millis();
+    analyzerRate = analyzerSecond;
+    analyzerSecond = 0;
+  }
+}
+
+// Average inter-arrival time in us (gaps excluded) ----
+unsigned long analyzerAverage() {
+  unsigned long count = analyzerPackets;
+  for (byte i = 0; i < analyzerGapBins; i++) count -= analyzerGaps[i];
+  if (count < 2) return 0;
+  return analyzerSum / (count - 1);
+}
+
+//
+// =======================================================================================================
+// EXPORT VIA SERIAL (CSV)
+// =======================================================================================================
+//
+
+// Serial is using pins 0 & 1 (SEL & LEFT buttons), so it's only active during the export (if not used for debugging) ----
+void analyzerExport() {
+#ifndef SERIAL_USED
+  Serial.begin(115200);
+#endif
+
+  Serial.print(F("frames,"));
+  Serial.print(analyzerPackets);
+  Serial.print(F(",rate,"));
+  Serial.print(analyzerRate);
+  Serial.print(F(",lost,"));
+  Serial.print(analyzerLost);
+  Serial.print(F(",min_us,"));
+  Serial.print(analyzerPackets > 1 ? analyzerMin : 0);
+  Serial.print(F(",avg_us,"));
+  Serial.print(analyzerAverage());
+  Serial.print(F(",max_us,"));
+  Serial.println(analyzerMax);
+
+  Serial.print(F("interval_ms"));
+  for (byte i = 0; i < analyzerBins; i++) {
+    Serial.print(',');
+    Serial.print(i);
+  }
+  Serial.print(F("\nframes"));
+  for (byte i = 0; i < analyzerBins; i++) {
+    Serial.print(',');
+    Serial.print(analyzerInterval[i]);
+  }
+
+  Serial.print(F("\ngap_ms"));
+  for (byte i = 0; i < analyzerGapBins; i++) {
+    Serial.print(',');
+    Serial.print(analyzerGapLimits[i]);
+  }
+  Serial.print(F("\ngaps"));
+  for (byte i = 0; i < analyzerGapBins; i++) {
+    Serial.print(',');
+    Serial.print(analyzerGaps[i]);
+  }
+
+  Serial.print(F("\nchannel"));
+  for (byte i = 0; i < analyzerChannels - 1; i++) {
+    Serial.print(',');
+    Serial.print(hopTable[i >> 1][i & 1]);
+  }
+  Serial.print(F(",other\nframes"));
+  for (byte i = 0; i < analyzerChannels; i++) {
+    Serial.print(',');
+    Serial.print(analyzerChannel[i]);
+  }
+  Serial.println();
+
+#ifndef SERIAL_USED
+  Serial.flush();
+  Serial.end();
+  pinMode(BUTTON_LEFT, INPUT_PULLUP); // the buttons are working again
+  pinMode(BUTTON_SEL, INPUT_PULLUP);
+  buttonsFlush(); // the Serial edges are no button events
+#endif
+}
+
+#endif
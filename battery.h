@@ -0,0 +1,124 @@
+/*
+  Battery discharge model for the "Micro RC" transmitter
+  The state of charge is looked up in the discharge curve of the battery type (per cell, integer millivolts). The
+  remaining runtime is estimated from the state of charge, which was used since the battery was connected.
+  Transmitter: 4 x Eneloop NiMH cells (the cutoff voltage is the empty point of the curve).
+  Vehicle: LiPo, the number of cells is detected from the first voltage, which is reported in the ACK payload.
+  Created by TheDIYGuy999
+*/
+
+#ifndef battery_h
+#define battery_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// DISCHARGE CURVES (per cell, in flash memory)
+// =======================================================================================================
+//
+
+struct dischargePoint {
+  uint16_t millivolts; // cell voltage under load
+  byte soc; // state of charge in %
+};
+
+// Eneloop NiMH, about 0.2C. 1.1V = the transmitter cutoff voltage = empty
+const dischargePoint nimhCurve[] PROGMEM = {
+  {1100, 0}, {1150, 5}, {1180, 10}, {1210, 20}, {1240, 40}, {1260, 60}, {1280, 75}, {1310, 90}, {1350, 100}
+};
+
+// LiPo
+const dischargePoint lipoCurve[] PROGMEM = {
+  {3300, 0}, {3500, 3}, {3650, 10}, {3700, 20}, {3750, 35}, {3800, 50}, {3870, 65}, {3950, 80}, {4100, 93}, {4200, 100}
+};
+
+const uint16_t lipoCellMax = 4250; // mV, for the cell count detection
+const byte txCells = (txProfile::cutoffMillivolts + 550) / 1100; // 4.4V = 4 NiMH cells
+
+//
+// =======================================================================================================
+// BATTERY MODEL VARIABLES
+// =======================================================================================================
+//
+
+const byte batteryMinUsed = 2; // % of used charge, before the runtime is estimated
+const byte batteryNewJump = 10; // % state of charge increase = a new battery
+const unsigned int batteryUnknown = 0xFFFF; // runtime not yet known
+
+struct batteryModel {
+  const dischargePoint *curve; // discharge curve in flash memory
+  byte points; // number of points in the curve
+  byte cells; // number of cells (0 = detect: LiPo only)
+  uint16_t millivolts; // averaged voltage (load peaks are filtered)
+  byte soc; // state of charge in %
+  byte socStart; // state of charge at the start of the estimation
+  unsigned long startMillis; // start of the estimation (0 = not started)
+  unsigned int runtime; // estimated remaining runtime in minutes
+};
+
+batteryModel txBattery = {nimhCurve, sizeof(nimhCurve) / sizeof(dischargePoint), 0};
+batteryModel vehicleBattery = {lipoCurve, sizeof(lipoCurve) / sizeof(dischargePoint), 0};
+
+//
+// =======================================================================================================
+// STATE OF CHARGE LOOKUP (linear interpolation between two points of the curve)
+// =======================================================================================================
+//
+
+byte batterySoc(const batteryModel &m, uint16_t cellMillivolts) {
+  uint16_t lowVolts = pgm_read_word(&m.curve[0].millivolts);
+  if (cellMillivolts <= lowVolts) return 0;
+
+  for (byte i = 1; i < m.points; i++) {
+    uint16_t highVolts = pgm_read_word(&m.curve[i].millivolts);
+    if (cellMillivolts < highVolts) {
+      byte lowSoc = pgm_read_byte(&m.curve[i - 1].soc);
+      byte highSoc = pgm_read_byte(&m.curve[i].soc);
+      return lowSoc + (unsigned long)(cellMillivolts - lowVolts) * (highSoc - lowSoc) / (highVolts - lowVolts);
+    }
+    lowVolts = highVolts;
+  }
+  return 100;
+}
+
+//
+// =======================================================================================================
+// RESET & UPDATE (every 500ms)
+// =======================================================================================================
+//
+
+// Battery changed (or an other vehicle) ----
+void batteryReset(batteryModel &m, byte cells) {
+  m.cells = cells;
+  m.millivolts = 0;
+  m.startMillis = 0;
+  m.runtime = batteryUnknown;
+}
+
+void batteryUpdate(batteryModel &m, uint16_t millivolts) {
+  if (millivolts == 0) return; // no measurement
+
+  // Average (about 4s) ----
+  if (m.millivolts == 0) m.millivolts = millivolts;
+  else m.millivolts += (int16_t)(millivolts - m.millivolts) / 8;
+
+  if (m.cells == 0) m.cells = (m.millivolts + lipoCellMax - 1) / lipoCellMax; // detect the LiPo cell count
+  byte soc = batterySoc(m, m.millivolts / m.cells);
+
+  // The state of charge is only going down (load changes), a jump up is a new battery ----
+  if (m.startMillis == 0 || soc > m.soc + batteryNewJump) {
+    m.soc = soc;
+    m.socStart = soc;
+    m.startMillis = millis() | 1; // never 0
+    m.runtime = batteryUnknown;
+    return;
+  }
+  if (soc < m.soc) m.soc = soc;
+
+  // Remaining runtime = time since the start * remaining charge / used charge ----
+  byte used = m.socStart - m.soc;
+  if (used >= batteryMinUsed) m.runtime = (millis() - m.startMillis) / 1000 * m.soc / used / 60;
+}
+
+#endif
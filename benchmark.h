@@ -0,0 +1,122 @@
+/*
+  A simple execution time profiler for the "Micro RC" transmitter. Enable it with the "BENCHMARK" build option.
+  Call count, average and worst case duration of the time critical functions are printed every 5s via Serial.
+  Created by TheDIYGuy999
+*/
+
+#ifndef benchmark_h
+#define benchmark_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// BENCHMARK VARIABLES
+// =======================================================================================================
+//
+
+#ifdef BENCHMARK
+
+// Measured functions (the order must match with the names below!)
+enum {
+  BENCH_LOOP,
+  BENCH_JOYSTICKS,
+  BENCH_RADIO,
+  BENCH_DISPLAY,
+  BENCH_IR,
+  BENCH_COUNT
+};
+
+const char benchName0[] PROGMEM = "loop()";
+const char benchName1[] PROGMEM = "readJoysticks()";
+const char benchName2[] PROGMEM = "transmitRadio()";
+const char benchName3[] PROGMEM = "updateDisplay()";
+const char benchName4[] PROGMEM = "buildIrSignal()";
+const char* const benchNames[BENCH_COUNT] PROGMEM = {
+  benchName0, benchName1, benchName2, benchName3, benchName4
+};
+
+// The active transmitter configuration (the results are only comparable within the same configuration!)
+#if defined CONFIG_MICRO_RC
+#define BENCH_CONFIG "CONFIG_MICRO_RC"
+#elif defined CONFIG_2_CH
+#define BENCH_CONFIG "CONFIG_2_CH"
+#elif defined CONFIG_3_CH
+#define BENCH_CONFIG "CONFIG_3_CH"
+#elif defined CONFIG_WLTOYS
+#define BENCH_CONFIG "CONFIG_WLTOYS"
+#elif defined CONFIG_WLTOYS_2
+#define BENCH_CONFIG "CONFIG_WLTOYS_2"
+#elif defined CONFIG_WLTOYS_MINI
+#define BENCH_CONFIG "CONFIG_WLTOYS_MINI"
+#else
+#define BENCH_CONFIG "unknown"
+#endif
+
+struct benchmarkEntry {
+  unsigned long calls; // number of calls since the last report
+  unsigned long totalMicros; // total duration of all calls since the last report
+  unsigned long worstMicros; // worst case duration since power on
+};
+benchmarkEntry benchmarkData[BENCH_COUNT];
+
+// Macros for the measured functions (only one start & stop per function!)
+#define BENCH_START(id) unsigned long benchStart = micros()
+#define BENCH_STOP(id) benchmarkStop(id, benchStart)
+
+//
+// =======================================================================================================
+// STORE A MEASUREMENT
+// =======================================================================================================
+//
+
+void benchmarkStop(byte id, unsigned long startMicros) {
+  unsigned long duration = micros() - startMicros;
+
+  benchmarkData[id].calls ++;
+  benchmarkData[id].totalMicros += duration;
+  if (duration > benchmarkData[id].worstMicros) benchmarkData[id].worstMicros = duration;
+}
+
+//
+// =======================================================================================================
+// PRINT THE BENCHMARK REPORT (call it at the very end of the main loop)
+// =======================================================================================================
+//
+
+void benchmarkReport() {
+
+  // Every 5 s
+  static unsigned long lastReport;
+  if (millis() - lastReport >= 5000) {
+    lastReport = millis();
+
+    Serial.print(F("Benchmark " BENCH_CONFIG ", "));
+    Serial.print(F_CPU / 1000000, DEC);
+    Serial.println(F("MHz: calls, avg. us, worst case us"));
+
+    for (byte i = 0; i < BENCH_COUNT; i++) {
+      Serial.print((const __FlashStringHelper*)pgm_read_ptr(&benchNames[i]));
+      Serial.print(F("\t"));
+      Serial.print(benchmarkData[i].calls);
+      Serial.print(F("\t"));
+      if (benchmarkData[i].calls > 0) Serial.print(benchmarkData[i].totalMicros / benchmarkData[i].calls);
+      else Serial.print(F("-"));
+      Serial.print(F("\t"));
+      Serial.println(benchmarkData[i].worstMicros);
+
+      // Start a new averaging window, but keep the worst case value
+      benchmarkData[i].calls = 0;
+      benchmarkData[i].totalMicros = 0;
+    }
+  }
+}
+
+#else // Benchmark not active, so the macros are empty ----
+
+#define BENCH_START(id)
+#define BENCH_STOP(id)
+
+#endif
+
+#endif
@@ -0,0 +1,253 @@
+/*
+  Interrupt driven button events for the "Micro RC" transmitter
+  Every edge of the 6 buttons is time stamped by the pin change interrupt and stored in a lock-free queue (the
+  interrupt is the only writer of the head, the main loop the only writer of the tail). A short press is never lost.
+  The debouncer in the main loop takes the first edge of a button and ignores the bouncing for 20ms, then the pin
+  level is checked again. It generates these events:
+  - BUTTON_PRESS, BUTTON_RELEASE
+  - BUTTON_CLICK: released before the long press time
+  - BUTTON_LONG: held for 800ms (no click is generated, when it's released)
+  - BUTTON_DOUBLE: second click within 300ms. Only for the buttons in "buttonsDoubleMask": their click is delayed
+    by 300ms, so it's only used, where the delay doesn't matter
+  Created by TheDIYGuy999
+*/
+
+#ifndef buttons_h
+#define buttons_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// BUTTON SETTINGS & VARIABLES
+// =======================================================================================================
+//
+
+// Buttons (the index is the bit number in the masks below)
+enum {
+  BTN_LEFT,
+  BTN_RIGHT,
+  BTN_SEL,
+  BTN_BACK,
+  BTN_JOYSTICK_LEFT,
+  BTN_JOYSTICK_RIGHT,
+  BTN_COUNT
+};
+
+const byte buttonPins[BTN_COUNT] = {BUTTON_LEFT, BUTTON_RIGHT, BUTTON_SEL, BUTTON_BACK, JOYSTICK_BUTTON_LEFT, JOYSTICK_BUTTON_RIGHT};
+
+// Events
+enum {
+  BUTTON_PRESS,
+  BUTTON_RELEASE,
+  BUTTON_CLICK,
+  BUTTON_LONG,
+  BUTTON_DOUBLE
+};
+
+const uint16_t buttonDebounce = 20; // ms
+const uint16_t buttonLongTime = 800; // ms
+const uint16_t buttonDoubleTime = 300; // ms, max. time between the two clicks
+
+// Serial is using pins 0 & 1 (SEL & LEFT buttons), so they can't be used with the Serial build options
+#ifdef SERIAL_USED
+const byte buttonsSerial = bit(BTN_SEL) | bit(BTN_LEFT);
+#else
+const byte buttonsSerial = 0;
+#endif
+
+// Pin registers (read by the interrupt)
+volatile uint8_t *buttonInput[BTN_COUNT];
+byte buttonBit[BTN_COUNT];
+
+// Edge queue: filled by the interrupt, size has to be a power of 2 ----
+const byte buttonsEdgeSize = 8;
+struct buttonEdge {
+  byte button; // bit 0 = level (1 = pressed), bit 1 - 3 = button
+  uint16_t time; // millis() (lower 16 bits)
+};
+buttonEdge buttonsEdges[buttonsEdgeSize];
+volatile byte buttonsEdgeHead = 0; // written by the interrupt only
+volatile byte buttonsEdgeTail = 0; // written by the main loop only
+volatile byte buttonsRaw = 0; // the latest pin levels (bit = 1: pressed)
+
+// Event queue: filled by the debouncer, read by readButtons() ----
+const byte buttonsEventSize = 8;
+byte buttonsEvents[buttonsEventSize]; // bit 0 - 2 = event, bit 3 - 5 = button
+byte buttonsEventHead = 0;
+byte buttonsEventTail = 0;
+
+// Debouncer ----
+byte buttonsState = 0; // debounced levels (bit = 1: pressed)
+byte buttonsLongSent = 0; // the long press event was already generated
+byte buttonsClickPending = 0; // a delayed click is waiting for the second one
+byte buttonsDoubleMask = 0; // buttons with double click detection (can be changed at any time)
+uint16_t buttonEdgeTime[BTN_COUNT]; // last accepted edge
+uint16_t buttonPressTime[BTN_COUNT];
+uint16_t buttonClickTime[BTN_COUNT];
+
+//
+// =======================================================================================================
+// PIN CHANGE INTERRUPT (one time stamp per edge)
+// =======================================================================================================
+//
+
+inline void buttonsEdge() {
+  uint16_t now = millis();
+  for (byte i = 0; i < BTN_COUNT; i++) {
+    if (bitRead(buttonsSerial, i)) continue;
+    byte pressed = !(*buttonInput[i] & buttonBit[i]);
+    if (pressed == bitRead(buttonsRaw, i)) continue; // not changed
+    buttonsRaw ^= bit(i);
+
+    byte next = (buttonsEdgeHead + 1) & (buttonsEdgeSize - 1);
+    if (next == buttonsEdgeTail) continue; // queue full (bouncing): the level is checked by the debouncer anyway
+    buttonsEdges[buttonsEdgeHead].button = (i << 1) | pressed;
+    buttonsEdges[buttonsEdgeHead].time = now;
+    buttonsEdgeHead = next;
+  }
+}
+
+ISR(PCINT0_vect) { // pins 8 - 13 (BACK, RIGHT)
+  buttonsEdge();
+}
+
+ISR(PCINT2_vect) { // pins 0 - 7 (SEL, LEFT, joystick buttons)
+  buttonsEdge();
+}
+
+//
+// =======================================================================================================
+// SETUP (the pins have to be configured before)
+// =======================================================================================================
+//
+
+// The current levels are taken without events ----
+void buttonsFlush() {
+  for (byte i = 0; i < BTN_COUNT; i++) {
+    if (bitRead(buttonsSerial, i)) continue;
+    if (digitalRead(buttonPins[i])) bitClear(buttonsState, i);
+    else bitSet(buttonsState, i);
+  }
+  uint8_t oldSREG = SREG;
+  cli();
+  buttonsRaw = buttonsState;
+  buttonsEdgeTail = buttonsEdgeHead;
+  SREG = oldSREG;
+  buttonsEventTail = buttonsEventHead;
+  buttonsLongSent = buttonsState; // a button, which is held, doesn't generate events
+  buttonsClickPending = 0;
+}
+
+void setupButtons() {
+  for (byte i = 0; i < BTN_COUNT; i++) {
+    buttonInput[i] = portInputRegister(digitalPinToPort(buttonPins[i]));
+    buttonBit[i] = digitalPinToBitMask(buttonPins[i]);
+  }
+  buttonsFlush();
+  for (byte i = 0; i < BTN_COUNT; i++) {
+    if (bitRead(buttonsSerial, i)) continue;
+    *digitalPinToPCMSK(buttonPins[i]) |= bit(digitalPinToPCMSKbit(buttonPins[i]));
+    *digitalPinToPCICR(buttonPins[i]) |= bit(digitalPinToPCICRbit(buttonPins[i]));
+  }
+}
+
+//
+// =======================================================================================================
+// DEBOUNCER (generates the events, called by readButtons())
+// =======================================================================================================
+//
+
+void buttonsPush(byte button, byte event) {
+  byte next = (buttonsEventHead + 1) & (buttonsEventSize - 1);
+  if (next == buttonsEventTail) return; // queue full
+  buttonsEvents[buttonsEventHead] = (button << 3) | event;
+  buttonsEventHead = next;
+}
+
+// Accepted level change ----
+void buttonsChange(byte i, boolean pressed, uint16_t time) {
+  buttonEdgeTime[i] = time;
+
+  if (pressed) {
+    bitSet(buttonsState, i);
+    bitClear(buttonsLongSent, i);
+    buttonPressTime[i] = time;
+    buttonsPush(i, BUTTON_PRESS);
+    return;
+  }
+
+  bitClear(buttonsState, i);
+  buttonsPush(i, BUTTON_RELEASE);
+  if (bitRead(buttonsLongSent, i)) return; // no click after a long press
+
+  if (!bitRead(buttonsDoubleMask, i)) buttonsPush(i, BUTTON_CLICK);
+  else if (bitRead(buttonsClickPending, i)) {
+    bitClear(buttonsClickPending, i);
+    buttonsPush(i, BUTTON_DOUBLE);
+  }
+  else {
+    bitSet(buttonsClickPending, i);
+    buttonClickTime[i] = time;
+  }
+}
+
+void buttonsUpdate() {
+
+  buttonsClickPending &= buttonsDoubleMask; // a delayed click is dropped, if the mask was changed
+
+  // Time stamped edges ----
+  while (buttonsEdgeTail != buttonsEdgeHead) {
+    buttonEdge edge = buttonsEdges[buttonsEdgeTail];
+    buttonsEdgeTail = (buttonsEdgeTail + 1) & (buttonsEdgeSize - 1);
+
+    byte i = edge.button >> 1;
+    boolean pressed = edge.button & 1;
+    if (pressed == bitRead(buttonsState, i)) continue;
+    if ((uint16_t)(edge.time - buttonEdgeTime[i]) < buttonDebounce) continue; // bouncing
+    buttonsChange(i, pressed, edge.time);
+  }
+
+  // Levels, long presses & delayed clicks ----
+  uint16_t now = millis();
+  for (byte i = 0; i < BTN_COUNT; i++) {
+    boolean pressed = bitRead(buttonsRaw, i);
+    if (pressed != bitRead(buttonsState, i) && (uint16_t)(now - buttonEdgeTime[i]) >= buttonDebounce) {
+      buttonsChange(i, pressed, now); // the last edge was ignored (bouncing or queue full)
+    }
+
+    if (bitRead(buttonsState, i) && !bitRead(buttonsLongSent, i) && (uint16_t)(now - buttonPressTime[i]) >= buttonLongTime) {
+      bitSet(buttonsLongSent, i);
+      if (bitRead(buttonsClickPending, i)) buttonsPush(i, BUTTON_CLICK); // the first click is not lost
+      bitClear(buttonsClickPending, i);
+      buttonsPush(i, BUTTON_LONG);
+    }
+
+    if (bitRead(buttonsClickPending, i) && !bitRead(buttonsState, i) && (uint16_t)(now - buttonClickTime[i]) >= buttonDoubleTime) {
+      bitClear(buttonsClickPending, i);
+      buttonsPush(i, BUTTON_CLICK);
+    }
+  }
+}
+
+//
+// =======================================================================================================
+// EVENT ACCESS
+// =======================================================================================================
+//
+
+// Returns false, if there is no event ----
+boolean buttonsNext(byte &button, byte &event) {
+  if (buttonsEventTail == buttonsEventHead) return false;
+  button = buttonsEvents[buttonsEventTail] >> 3;
+  event = buttonsEvents[buttonsEventTail] & 0x07;
+  buttonsEventTail = (buttonsEventTail + 1) & (buttonsEventSize - 1);
+  return true;
+}
+
+// Debounced level ----
+boolean buttonPressed(byte button) {
+  return bitRead(buttonsState, button);
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+  Vehicle discovery scan for the "Micro RC" transmitter
+  All pipe addresses are probed with a neutral frame in one sweep. The vehicles, which are acknowledging it, are
+  listed with their battery voltage (from the ACK payload). A receiver without signal is searching on the channels
+  of the hop table, so every sweep is done on the next channel of the table. The list is complete after a few
+  sweeps (one sweep = about 100ms).
+  Created by TheDIYGuy999
+*/
+
+#ifndef discovery_h
+#define discovery_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// DISCOVERY SETTINGS & VARIABLES
+// =======================================================================================================
+//
+
+const byte discoveryRetries = 2; // max. auto retransmits per probe (a sweep has to be short)
+const byte discoveryKeep = hopSlots * 2 * 2; // a vehicle is listed for 16 sweeps (2 rounds on all channels) after its last ACK
+const byte discoveryNone = 0xFF;
+
+boolean discoveryActive = false;
+boolean discoveryBusy = false; // a probe is in the air
+byte discoveryPipe = 0; // the pipe of the current probe (0 = vehicle 1)
+byte discoverySweep = 0; // the channel of a sweep is selected by its number
+unsigned long discoveryStartMicros; // start of the current probe
+uint16_t discoveryBattery[maxVehicleNumber]; // vehicle battery voltage in mV
+byte discoverySeen[maxVehicleNumber]; // sweeps since the last ACK (discoveryKeep = not found)
+byte discoveryCursor = discoveryNone; // the selected vehicle of the list (0 = vehicle 1)
+
+//
+// =======================================================================================================
+// START & STOP THE SCAN
+// =======================================================================================================
+//
+
+void discoveryStart() {
+  if (txBusy) radio.flush_tx(); // drop the frame to the active vehicle
+  txBusy = false;
+  resetLinkControl(); // probes are sent with 250kbps and max. PA
+  radio.setRetries(3, discoveryRetries); // 1000us delay (enough for the ACK payload @ 250kbps)
+  memset(discoverySeen, discoveryKeep, sizeof(discoverySeen));
+  discoveryPipe = 0;
+  discoverySweep = 0;
+  discoveryBusy = false;
+  discoveryCursor = discoveryNone;
+  discoveryActive = true;
+}
+
+// The pipe address of the active vehicle has to be restored afterwards ----
+void discoveryStop() {
+  if (discoveryBusy) radio.flush_tx();
+  discoveryBusy = false;
+  radio.setRetries(5, 5); // see setupRadio()
+  discoveryActive = false;
+}
+
+//
+// =======================================================================================================
+// DISCOVERY TASK (replaces the radio status polling in the idle time, one probe at a time)
+// =======================================================================================================
+//
+
+void discoveryTask() {
+
+  // Result of the current probe ----
+  if (discoveryBusy) {
+    bool txOk, txFail, rxReady;
+    radio.whatHappened(txOk, txFail, rxReady); // read and clear the status flags
+    if (!txOk && !txFail && micros() - discoveryStartMicros < txTimeout) return; // still in the air
+
+    if (txOk) {
+      discoverySeen[discoveryPipe] = 0;
+      discoveryBattery[discoveryPipe] = 0;
+      if (radio.isAckPayloadAvailable()) {
+        byte ack[maxFrameSize];
+        byte len = radio.getDynamicPayloadSize();
+        if (len > maxFrameSize) len = maxFrameSize;
+        radio.read(ack, len);
+        telemetryData active = payload; // the telemetry of the active vehicle is not changed
+        byte echo;
+        if (decodeAck(ack, len, echo)) discoveryBattery[discoveryPipe] = payload.batteryVoltage;
+        payload = active;
+      }
+    }
+    else radio.flush_tx(); // no vehicle with this address
+    discoveryBusy = false;
+
+    // Sweep completed: age the entries ----
+    if (++discoveryPipe >= maxVehicleNumber) {
+      discoveryPipe = 0;
+      discoverySweep ++;
+      for (byte i = 0; i < maxVehicleNumber; i++) {
+        if (discoverySeen[i] < discoveryKeep) discoverySeen[i] ++;
+      }
+    }
+  }
+
+  // Next probe: a neutral frame (the joystick positions are never sent to an other vehicle) ----
+  if (discoveryPipe == 0) radio.setChannel(hopTable[(discoverySweep >> 1) & (hopSlots - 1)][discoverySweep & 1]);
+  radio.openWritingPipe(pgm_read_64(&pipeOut, discoveryPipe));
+
+  RcData active = data;
+  int activeFine[4];
+  memcpy(activeFine, axisFine, sizeof(axisFine));
+  data.axis1 = data.axis2 = data.axis3 = data.axis4 = 50;
+  data.momentary1 = false;
+  for (byte i = 0; i < 4; i++) axisFine[i] = 500;
+
+  byte frame[maxFrameSize];
+  radio.startWrite(frame, encodeRcData(frame), false);
+  discoveryStartMicros = micros();
+  discoveryBusy = true;
+
+  data = active;
+  memcpy(axisFine, activeFine, sizeof(axisFine));
+}
+
+//
+// =======================================================================================================
+// LIST NAVIGATION
+// =======================================================================================================
+//
+
+boolean discoveryFound(byte vehicle) {
+  return discoverySeen[vehicle] < discoveryKeep;
+}
+
+// Move the cursor to the next (up = true) or previous found vehicle ----
+void discoveryMove(boolean up) {
+  byte i = (discoveryCursor == discoveryNone) ? (up ? maxVehicleNumber - 1 : 0) : discoveryCursor;
+  for (byte n = 0; n < maxVehicleNumber; n++) {
+    if (up) i = (i + 1 < maxVehicleNumber) ? i + 1 : 0;
+    else i = (i > 0) ? i - 1 : maxVehicleNumber - 1;
+    if (discoveryFound(i)) {
+      discoveryCursor = i;
+      return;
+    }
+  }
+  discoveryCursor = discoveryNone; // nothing found
+}
+
+#endif
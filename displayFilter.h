@@ -0,0 +1,65 @@
+/*
+  Dirty page filter for u8glib page buffer displays (SSD1306 / SH1106 128 x 64, 8 pages of 8 rows).
+  A CRC16 of each rendered page is compared with the one of the last page sent. Unchanged pages are not
+  transferred via I2C. This saves about 3ms per page @ 400kHz I2C.
+  Created by TheDIYGuy999
+*/
+
+#ifndef displayFilter_h
+#define displayFilter_h
+
+#include "Arduino.h"
+#include <util/crc16.h>
+
+//
+// =======================================================================================================
+// DISPLAY FILTER VARIABLES
+// =======================================================================================================
+//
+
+const byte displayPages = 8; // 64 rows / 8 rows per page
+
+uint16_t pageChecksum[displayPages]; // CRC16 of the pages, which are currently shown on the display
+boolean displayForceAll = true; // transfer all pages during the next frame (after power on)
+u8g_dev_fnptr displayDeviceFunction; // the original u8glib device function
+
+//
+// =======================================================================================================
+// DEVICE FUNCTION HOOK (called by u8glib for every device message)
+// =======================================================================================================
+//
+
+uint8_t displayPageFilter(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg) {
+
+  if (msg == U8G_DEV_MSG_PAGE_NEXT) { // the current page is rendered and would be sent now
+    u8g_pb_t *pb = (u8g_pb_t *)(dev->dev_mem);
+    byte page = pb->p.page;
+
+    uint16_t crc = 0xFFFF;
+    const byte *buf = (const byte *)pb->buf;
+    for (byte i = 0; i < pb->width; i++) crc = _crc_ccitt_update(crc, buf[i]);
+
+    if (page < displayPages) {
+      if (crc == pageChecksum[page] && !displayForceAll) {
+        return u8g_dev_pb8v1_base_fn(u8g, dev, msg, arg); // unchanged: skip the I2C transfer, just clear the buffer and go to the next page
+      }
+      pageChecksum[page] = crc;
+      if (page == displayPages - 1) displayForceAll = false;
+    }
+  }
+  return displayDeviceFunction(u8g, dev, msg, arg); // send the page
+}
+
+//
+// =======================================================================================================
+// DISPLAY FILTER SETUP
+// =======================================================================================================
+//
+
+void setupDisplayFilter(U8GLIB &display) {
+  u8g_dev_t *dev = display.getU8g()->dev;
+  displayDeviceFunction = dev->dev_fn;
+  dev->dev_fn = displayPageFilter;
+}
+
+#endif
@@ -0,0 +1,143 @@
+/*
+  Frequency hopping engine for the "Micro RC" transmitter
+
+  Legacy protocol: all channels of NRFchannel[] are used in a row (max. 4 channels).
+  Packed protocol: the hop table has 4 slots with a primary and a spare channel each. The slot of a frame is
+  selected by its sequence number (sequence & 3), so the receiver knows the next channel after every received
+  frame. The hop mask, which is sent in every frame, tells the receiver, which slots are using the spare channel.
+  The ACK success and the retries are rated per channel. A slot with a bad channel is switched to its spare.
+  The receiver stays on the channel of a received frame for the hold time, because the ACK can be lost: the
+  transmitter sends the same frame again on this channel (auto retransmit), before it hops to the next one.
+  Created by TheDIYGuy999
+*/
+
+#ifndef hopping_h
+#define hopping_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// HOPPING SETTINGS & VARIABLES
+// =======================================================================================================
+//
+
+const byte hopSlots = 4; // the hop mask has 4 bits
+static_assert(sizeof(NRFchannel) <= hopSlots, "Max. 4 legacy channels");
+
+#ifdef PACKED_PROTOCOL
+const byte hopSequenceLength = hopSlots; // a receiver, which missed a frame, waits for this number of frames on its channel
+#else
+const byte hopSequenceLength = sizeof(NRFchannel); // the legacy receiver stays on one channel
+#endif
+const unsigned long hopSearchTimeout = 50; // ms without a frame, before the receiver searches the signal (see readRadio())
+
+const byte hopQualityLimit = 80; // a channel with a lower link quality (0 - 255) is replaced by the spare channel
+const unsigned int hopMinFrames = 64; // min. number of frames on a channel, before it is replaced (about 1.3s)
+const byte hopRetryPenalty = 40; // quality reduction per auto retransmit
+
+struct hopChannelStats {
+  unsigned int frames; // number of sent frames
+  unsigned int acks; // number of acknowledged frames
+  unsigned int retries; // number of auto retransmits
+  byte quality = 255; // link quality 0 - 255 (moving average)
+};
+hopChannelStats hopStats[hopSlots][2]; // per slot: primary & spare channel
+
+byte hopMask = 0; // bit n set = slot n is using the spare channel
+byte hopSlot = 0; // the slot of the current frame
+unsigned int hopHold[hopSlots]; // frames on the current channel of each slot
+byte hopSearchPointer = 0; // channel search (radio tester mode)
+
+const unsigned int hopFollowHold = 4000; // us, the receiver hops after 2 auto retransmits (1.5ms), but before the next frame (5ms)
+boolean hopFollowPending = false; // the receiver has to switch to the channel of hopSlot
+unsigned long hopFollowMicros; // time stamp of the last received frame
+
+//
+// =======================================================================================================
+// TRANSMITTER: CHANNEL OF THE NEXT FRAME
+// =======================================================================================================
+//
+
+byte hopChannel(byte slot) {
+  return hopTable[slot][(hopMask >> slot) & 1];
+}
+
+byte hopNext(byte sequence) {
+#ifdef PACKED_PROTOCOL
+  hopSlot = sequence & (hopSlots - 1);
+  return hopChannel(hopSlot);
+#else
+  chPointer ++;
+  if (chPointer >= sizeof(NRFchannel)) chPointer = 0;
+  hopSlot = chPointer;
+  return NRFchannel[chPointer];
+#endif
+}
+
+//
+// =======================================================================================================
+// TRANSMITTER: RATE THE CHANNEL OF THE LAST FRAME
+// =======================================================================================================
+//
+
+// "linkUp" = other frames were acknowledged recently. Otherwise the receiver is off and not the channel is bad ----
+void hopResult(boolean ok, byte retries, boolean linkUp) {
+  byte spare = (hopMask >> hopSlot) & 1;
+#ifndef PACKED_PROTOCOL
+  spare = 0;
+#endif
+  hopChannelStats &s = hopStats[hopSlot][spare];
+
+  s.frames ++;
+  if (ok) {
+    s.acks ++;
+    s.retries += retries;
+  }
+
+  if (!linkUp) return;
+
+  int sample = ok ? 255 - min(retries * hopRetryPenalty, 255) : 0;
+  s.quality += (sample - s.quality) / 16;
+
+#ifdef PACKED_PROTOCOL
+  // Replace a bad channel by the spare channel of the same slot (the receiver is informed by the hop mask) ----
+  if (hopHold[hopSlot] < hopMinFrames) hopHold[hopSlot] ++;
+  else if (s.quality < hopQualityLimit) {
+    hopMask ^= 1 << hopSlot;
+    hopHold[hopSlot] = 0;
+    hopStats[hopSlot][spare ^ 1].quality = 255; // give the other channel a new chance
+  }
+#endif
+}
+
+//
+// =======================================================================================================
+// RECEIVER (radio tester mode): FOLLOW THE HOP SEQUENCE
+// =======================================================================================================
+//
+
+// After a packed frame: the slot of the next frame. The channel is switched after the hold time ----
+void hopFollow(byte sequence, byte mask, unsigned long timestamp) {
+  hopMask = mask;
+  hopSlot = (sequence + 1) & (hopSlots - 1);
+  hopFollowPending = true;
+  hopFollowMicros = timestamp;
+}
+
+// True, if the hold time is over and the radio has to be switched to hopChannel(hopSlot) ----
+boolean hopFollowDue() {
+  if (!hopFollowPending || micros() - hopFollowMicros < hopFollowHold) return false;
+  hopFollowPending = false;
+  return true;
+}
+
+// No signal: try all channels of the hop table (includes the legacy channels 1 & 2) ----
+byte hopSearch() {
+  hopFollowPending = false;
+  hopSearchPointer ++;
+  if (hopSearchPointer >= hopSlots * 2) hopSearchPointer = 0;
+  return hopTable[hopSearchPointer >> 1][hopSearchPointer & 1];
+}
+
+#endif
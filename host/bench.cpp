@@ -0,0 +1,87 @@
+/*
+  Host benchmark of the "Micro RC" transmitter hot paths (see Makefile)
+  The sketch runs with the simulated hardware, a receiver acknowledges every frame (a lossy one with retries in the
+  "lossy" pass). Average and worst case execution time of each function are measured with the host clock. The host
+  is much faster than the 8MHz AVR, so only compare the results of the same host & build (before / after a change).
+  The execution times on the transmitter are reported by the "BENCHMARK" build option (see benchmark.h).
+  Created by TheDIYGuy999
+*/
+
+#include <chrono> // before the sketch (min() & max() macros)
+#include "sketch.cpp"
+
+const unsigned long benchRuns = 20000;
+
+// Run a function "benchRuns" times. The simulated time advances by "period" microseconds before each call ----
+// "us sim." is the longest simulated time during a call: waiting for the hardware (e.g. radio.write()) or the idle sleep
+// of loop() until the next interrupt ----
+void bench(const char *name, void (*function)(), uint32_t period) {
+  double total = 0, worst = 0;
+  uint64_t simulatedMax = 0;
+  for (unsigned long i = 0; i < benchRuns; i++) {
+    hostAdvance(period);
+    if (hostRadioSent.size() > 1000) hostRadioSent.clear(); // the frame log is not part of the measurement
+    uint64_t simulated = hostMicros;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    function();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    total += ns;
+    if (ns > worst) worst = ns;
+    if (hostMicros - simulated > simulatedMax) simulatedMax = hostMicros - simulated;
+  }
+  printf("%-20s %10.0f ns avg. %10.0f ns max. %6lu us sim. max.\n", name, total / benchRuns, worst, (unsigned long)simulatedMax);
+}
+
+// Receiver with a lossy link: every attempt is lost with 30%, up to 5 auto retransmits (setRetries(5, 5)) ----
+uint32_t noise = 1;
+
+hostAck lossyPeer(const hostFrame &frame) {
+  hostAck ack = {false, 0, 0, {0}};
+  for (byte attempt = 0; attempt <= 5 && !ack.ok; attempt++) {
+    noise = noise * 1103515245 + 12345;
+    if ((noise >> 16) % 100 >= 30) ack.ok = true;
+    else ack.retries++;
+  }
+  return ack;
+}
+
+int main() {
+  hostRadioPeer = [](const hostFrame & frame) {
+    hostAck ack = {true, 0, 0, {0}};
+    return ack;
+  };
+  setup();
+
+  // Joysticks are moving, so every frame is sent with the full rate
+  static unsigned long step;
+  hostAnalog[0] = 300;
+
+  bench("mapJoystick()", [] { mapJoystick(A1, 1); }, 0);
+  bench("readJoysticks()", [] { hostAnalog[1] = 200 + step++ % 600; readJoysticks(); }, 5000);
+  bench("buildTransforms()", [] { buildTransforms(); }, 0);
+  bench("encodeRcData()", [] { byte frame[maxFrameSize]; encodeRcData(frame); }, 0);
+  bench("transmitRadio()", [] { hostAnalog[1] = 200 + step++ % 600; readJoysticks(); transmitRadio(); }, 5000);
+  bench("drawDisplay()", [] { hostAnalog[1] = 200 + step++ % 600; readJoysticks(); drawDisplay(); }, 0);
+  bench("controlTask()", [] { hostAnalog[1] = 200 + step++ % 600; controlTask(); }, 5000);
+  bench("loop()", [] { hostAnalog[1] = 200 + step++ % 600; loop(); }, 100);
+
+  // Lossy link: loop() doesn't wait for the retransmits. radio.write() is the former blocking transmission
+  hostRadioPeer = lossyPeer;
+  bench("loop() lossy", [] { hostAnalog[1] = 200 + step++ % 600; loop(); }, 100);
+  bench("radio.write() lossy", [] { byte frame[maxFrameSize]; radio.write(frame, encodeRcData(frame)); }, 5000);
+  hostRadioPeer = [](const hostFrame & frame) {
+    hostAck ack = {true, 0, 0, {0}};
+    return ack;
+  };
+
+  // MECCANO IR mode (profiles with infrared only): the commands are queued, the pulses are sent by the timer interrupt
+  if (txProfile::infrared) {
+    transmissionMode = 3;
+    bench("buildIrSignal()", [] { buildIrSignal(1 + step++ % meccanoCommands); }, 5000);
+    bench("controlTask() IR", [] { hostAnalog[1] = 200 + step++ % 600; controlTask(); }, 5000);
+    bench("loop() IR", [] { hostAnalog[1] = 200 + step++ % 600; loop(); }, 100);
+    transmissionMode = 1;
+  }
+
+  return 0;
+}
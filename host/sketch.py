@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""
+Converts the sketch into a C++ file for the host build, like the Arduino IDE does:
+"#include <Arduino.h>" is added and the function prototypes are inserted before the first function.
+
+Usage: sketch.py RC_Transmitter.ino > sketch.cpp
+Created by TheDIYGuy999
+"""
+
+import os
+import re
+import sys
+
+# return type, name, parameters and the opening brace of a function definition at the top level
+FUNCTION = re.compile(r'^([A-Za-z_][\w<>:\s\*&]*?[\s\*&])([A-Za-z_]\w*)\s*\(([^;{}]*)\)\s*\{')
+KEYWORDS = ('else', 'return', 'struct', 'class', 'switch', 'if', 'while', 'for', 'do')
+
+
+def strip_comments(line):
+    line = re.sub(r'"(\\.|[^"\\])*"', '""', line)
+    line = re.sub(r"'(\\.|[^'\\])*'", "''", line)
+    return line.split('//')[0]
+
+
+def main():
+    path = sys.argv[1]
+    lines = open(path).read().split('\n')
+    name = os.path.abspath(path)
+
+    prototypes = []
+    first = None
+    depth = 0
+    for i, line in enumerate(lines):
+        if depth == 0:
+            match = FUNCTION.match(line)
+            if match and match.group(1).split()[0] not in KEYWORDS:
+                if first is None:
+                    first = i
+                parameters = re.sub(r'\s*=\s*[^,]+', '', match.group(3))  # no default arguments in prototypes
+                prototypes.append(match.group(1) + match.group(2) + '(' + parameters + ');')
+        code = strip_comments(line)
+        depth += code.count('{') - code.count('}')
+
+    out = ['#include <Arduino.h>', '#line 1 "%s"' % name]
+    out += lines[:first] + prototypes
+    out += ['#line %d "%s"' % (first + 1, name)] + lines[first:]
+    print('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,167 @@
+/*
+  Arduino core stand-in for the host build (ATmega328P registers, pins, time, Serial)
+  Created by TheDIYGuy999
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include "host.h" // the C++ library headers have to be included before the min() & max() macros
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+// Flash memory: the host has only one address space
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void * const *)(p))
+#define memcpy_P memcpy
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+
+// Macros of the Arduino AVR core
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define abs(x) ((x) > 0 ? (x) : -(x))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bit(b) (1UL << (b))
+#define bitRead(value, b) (((value) >> (b)) & 0x01)
+#define bitSet(value, b) ((value) |= (1UL << (b)))
+#define bitClear(value, b) ((value) &= ~(1UL << (b)))
+#define bitWrite(value, b, bitvalue) ((bitvalue) ? bitSet(value, b) : bitClear(value, b))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define _BV(b) (1 << (b))
+#define bit_is_set(sfr, b) ((sfr) & _BV(b))
+#define bit_is_clear(sfr, b) (!((sfr) & _BV(b)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+// Interrupts: ISR() defines a C function, which is called by the simulated hardware
+#define ISR(vector) extern "C" void vector(void)
+void cli();
+void sei();
+#define noInterrupts() cli()
+#define interrupts() sei()
+
+// ATmega328P registers, which are used by the sketch
+extern volatile uint8_t SREG;
+extern volatile uint8_t ADMUX, ADCSRA, ADCSRB, DIDR0;
+extern volatile uint16_t ADC;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1, OCR1A;
+extern volatile uint8_t TCCR2A, TCCR2B, OCR2A, OCR2B;
+extern volatile uint8_t PCICR, PCMSK0, PCMSK1, PCMSK2;
+extern volatile uint8_t PINB, PINC, PIND;
+
+enum {
+  REFS1 = 7, REFS0 = 6, ADLAR = 5,
+  ADEN = 7, ADSC = 6, ADATE = 5, ADIF = 4, ADIE = 3, ADPS2 = 2, ADPS1 = 1, ADPS0 = 0,
+  WGM10 = 0, WGM11 = 1, WGM12 = 3, WGM13 = 4, CS10 = 0, CS11 = 1, CS12 = 2, OCIE1A = 1, OCF1A = 1,
+  WGM20 = 0, WGM21 = 1, WGM22 = 3, COM2B0 = 4, COM2B1 = 5, CS20 = 0, CS21 = 1, CS22 = 2
+};
+
+// Pin mapping of the ATmega328P (port B: pin 8 - 13, port C: A0 - A5, port D: pin 0 - 7)
+#define NOT_A_PORT 0
+#define PB 2
+#define PC 3
+#define PD 4
+#define digitalPinToPort(p) ((p) <= 7 ? PD : ((p) <= 13 ? PB : PC))
+#define digitalPinToBitMask(p) ((uint8_t)(1 << ((p) <= 7 ? (p) : ((p) <= 13 ? (p) - 8 : (p) - 14))))
+#define portInputRegister(port) ((port) == PD ? &PIND : ((port) == PB ? &PINB : &PINC))
+#define digitalPinToPCICR(p) (&PCICR)
+#define digitalPinToPCICRbit(p) ((p) <= 7 ? 2 : ((p) <= 13 ? 0 : 1))
+#define digitalPinToPCMSK(p) ((p) <= 7 ? &PCMSK2 : ((p) <= 13 ? &PCMSK0 : &PCMSK1))
+#define digitalPinToPCMSKbit(p) ((p) <= 7 ? (p) : ((p) <= 13 ? (p) - 8 : (p) - 14))
+
+//
+// =======================================================================================================
+// PRINT & SERIAL
+// =======================================================================================================
+//
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str);
+
+    size_t print(const __FlashStringHelper *str);
+    size_t print(const char *str);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println();
+    template <class T> size_t println(T value) {
+      size_t n = print(value);
+      return n + println();
+    }
+    template <class T> size_t println(T value, int format) {
+      size_t n = print(value, format);
+      return n + println();
+    }
+
+  private:
+    size_t printNumber(unsigned long n, uint8_t base);
+};
+
+class HardwareSerial : public Print {
+  public:
+    void begin(unsigned long baud);
+    void end();
+    int available();
+    int read();
+    int availableForWrite();
+    void flush();
+    size_t write(uint8_t c);
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,23 @@
+/*
+  EEPROMex stand-in for the host build (1024 bytes, see "hostEeprom" in host.h)
+  Created by TheDIYGuy999
+*/
+
+#ifndef EEPROMex_h
+#define EEPROMex_h
+
+#include "Arduino.h"
+
+class EEPROMClassEx {
+  public:
+    int getAddress(int noOfBytes);
+    uint8_t readByte(int address);
+    bool updateByte(int address, uint8_t value);
+
+  private:
+    int nextAddress = 0;
+};
+
+extern EEPROMClassEx EEPROM;
+
+#endif
@@ -0,0 +1,34 @@
+/*
+  LegoIr stand-in for the host build: the packets are stored in "hostLegoTrace" (see host.h)
+  Created by TheDIYGuy999
+*/
+
+#ifndef LegoIr_h
+#define LegoIr_h
+
+#include "Arduino.h"
+
+#define PWM_FLT 0x0
+#define PWM_FWD1 0x1
+#define PWM_FWD2 0x2
+#define PWM_FWD3 0x3
+#define PWM_FWD4 0x4
+#define PWM_FWD5 0x5
+#define PWM_FWD6 0x6
+#define PWM_FWD7 0x7
+#define PWM_BRK 0x8
+#define PWM_REV7 0x9
+#define PWM_REV6 0xA
+#define PWM_REV5 0xB
+#define PWM_REV4 0xC
+#define PWM_REV3 0xD
+#define PWM_REV2 0xE
+#define PWM_REV1 0xF
+
+class LegoIr {
+  public:
+    void begin(uint8_t pin, uint8_t channel) {}
+    void combo_pwm(uint8_t blue, uint8_t red);
+};
+
+#endif
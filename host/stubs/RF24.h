@@ -0,0 +1,56 @@
+/*
+  NRF24L01 (RF24 library) stand-in for the host build
+  The frames are passed to "hostRadioPeer" (the receiver), which decides about the ACK, the number of auto
+  retransmits and the ACK payload. The result is reported after the simulated air time (see host.h).
+  Created by TheDIYGuy999
+*/
+
+#ifndef RF24_h
+#define RF24_h
+
+#include "Arduino.h"
+
+typedef enum { RF24_PA_MIN = 0, RF24_PA_LOW, RF24_PA_HIGH, RF24_PA_MAX, RF24_PA_ERROR } rf24_pa_dbm_e;
+typedef enum { RF24_1MBPS = 0, RF24_2MBPS, RF24_250KBPS } rf24_datarate_e;
+typedef enum { RF24_CRC_DISABLED = 0, RF24_CRC_8, RF24_CRC_16 } rf24_crclength_e;
+
+class RF24 {
+  public:
+    RF24(uint16_t cePin, uint16_t csnPin);
+
+    bool begin();
+    void powerUp();
+    void powerDown();
+    void printDetails();
+
+    void setChannel(uint8_t channel);
+    uint8_t getChannel();
+    void setPALevel(uint8_t level);
+    bool setDataRate(rf24_datarate_e speed);
+    void setCRCLength(rf24_crclength_e length);
+    void setAutoAck(bool enable);
+    void setAutoAck(uint8_t pipe, bool enable);
+    void enableAckPayload();
+    void enableDynamicPayloads();
+    void setRetries(uint8_t delay, uint8_t count);
+    uint8_t getARC();
+
+    void openWritingPipe(uint64_t address);
+    void openReadingPipe(uint8_t number, uint64_t address);
+    void startListening();
+    void stopListening();
+
+    bool write(const void *buf, uint8_t len);
+    bool startWrite(const void *buf, uint8_t len, const bool multicast);
+    void whatHappened(bool &tx_ok, bool &tx_fail, bool &rx_ready);
+    uint8_t flush_tx();
+    bool isAckPayloadAvailable();
+
+    bool available();
+    bool available(uint8_t *pipe_num);
+    uint8_t getDynamicPayloadSize();
+    void read(void *buf, uint8_t len);
+    void writeAckPayload(uint8_t pipe, const void *buf, uint8_t len);
+};
+
+#endif
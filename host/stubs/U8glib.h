@@ -0,0 +1,101 @@
+/*
+  U8glib stand-in for the host build (SSD1306 128 x 64 with a page buffer of 8 rows)
+  The page loop and the device function are working like in u8glib, so the page filter (see "displayFilter.h")
+  can be hooked in. Text and graphics are rendered as simple bit patterns, every change of the content changes the
+  page buffer. The transferred pages are stored in "hostDisplay" (see host.h).
+  Created by TheDIYGuy999
+*/
+
+#ifndef _U8GLIB
+#define _U8GLIB
+
+#include "Arduino.h"
+
+#define U8G_I2C_OPT_NONE 0
+#define U8G_I2C_OPT_FAST 16
+
+#define U8G_DRAW_ALL 0x0F
+
+#define U8G_DEV_MSG_INIT 10
+#define U8G_DEV_MSG_PAGE_FIRST 20
+#define U8G_DEV_MSG_PAGE_NEXT 21
+
+typedef uint8_t u8g_uint_t;
+typedef struct _u8g_t u8g_t;
+typedef struct _u8g_dev_t u8g_dev_t;
+typedef uint8_t (*u8g_dev_fnptr)(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg);
+
+struct _u8g_dev_t {
+  u8g_dev_fnptr dev_fn;
+  void *dev_mem;
+};
+
+typedef struct _u8g_page_t {
+  u8g_uint_t page_height;
+  u8g_uint_t total_height;
+  u8g_uint_t page_y0;
+  u8g_uint_t page_y1;
+  uint8_t page;
+} u8g_page_t;
+
+typedef struct _u8g_pb_t {
+  u8g_page_t p;
+  u8g_uint_t width;
+  void *buf;
+} u8g_pb_t;
+
+struct _u8g_t {
+  u8g_uint_t width;
+  u8g_uint_t height;
+  u8g_dev_t *dev;
+};
+
+// Clears the page buffer (PAGE_FIRST, PAGE_NEXT) and selects the next page. Returns 0 after the last page
+uint8_t u8g_dev_pb8v1_base_fn(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg);
+
+extern const uint8_t u8g_font_6x10[];
+
+class U8GLIB : public Print {
+  public:
+    U8GLIB();
+
+    u8g_t *getU8g() { return &u8g; }
+    void firstPage();
+    uint8_t nextPage();
+
+    void setFont(const uint8_t *font) {}
+    void setFontRefHeightExtendedText() {}
+    void setDefaultForegroundColor() { color = 1; }
+    void setFontPosTop() {}
+    void setColorIndex(uint8_t index) { color = index; }
+
+    void setPrintPos(int x, int y) { tx = x; ty = y; }
+    size_t write(uint8_t c);
+    using Print::write;
+    void drawStr(int x, int y, const char *s);
+    void drawStr(int x, int y, const __FlashStringHelper *s);
+
+    void drawPixel(int x, int y);
+    void drawHLine(int x, int y, int w);
+    void drawVLine(int x, int y, int h);
+    void drawLine(int x1, int y1, int x2, int y2);
+    void drawFrame(int x, int y, int w, int h);
+    void drawBox(int x, int y, int w, int h);
+    void drawCircle(int x0, int y0, int rad, uint8_t option = U8G_DRAW_ALL);
+    void drawDisc(int x0, int y0, int rad, uint8_t option = U8G_DRAW_ALL);
+
+  private:
+    u8g_t u8g;
+    u8g_dev_t dev;
+    u8g_pb_t pb;
+    uint8_t buf[128];
+    uint8_t color;
+    int tx, ty;
+};
+
+class U8GLIB_SSD1306_128X64 : public U8GLIB {
+  public:
+    U8GLIB_SSD1306_128X64(uint8_t options) {}
+};
+
+#endif
@@ -0,0 +1,19 @@
+/*
+  avr-libc EEPROM functions for the host build (see "hostEeprom" in host.h)
+  Created by TheDIYGuy999
+*/
+
+#ifndef _AVR_EEPROM_H_
+#define _AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define E2END 1023
+
+bool eeprom_is_ready();
+uint8_t eeprom_read_byte(const uint8_t *address);
+void eeprom_update_byte(uint8_t *address, uint8_t value);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+
+#endif
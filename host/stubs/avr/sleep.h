@@ -0,0 +1,18 @@
+/*
+  avr-libc sleep functions for the host build: sleep_cpu() lets the time pass until the next interrupt
+  Created by TheDIYGuy999
+*/
+
+#ifndef _AVR_SLEEP_H_
+#define _AVR_SLEEP_H_
+
+#include <stdint.h>
+
+#define SLEEP_MODE_IDLE 0
+
+inline void set_sleep_mode(uint8_t mode) {}
+inline void sleep_enable() {}
+inline void sleep_disable() {}
+void sleep_cpu();
+
+#endif
@@ -0,0 +1,821 @@
+/*
+  Host simulation of the "Micro RC" transmitter hardware (see host.h)
+  Created by TheDIYGuy999
+*/
+
+#include "Arduino.h"
+#include "RF24.h"
+#include "U8glib.h"
+#include "EEPROMex.h"
+#include "LegoIr.h"
+#include "SPI.h"
+#include <avr/eeprom.h>
+#include <avr/sleep.h>
+
+// Interrupt service routines of the sketch (weak: not every tab is using all of them)
+extern "C" void ADC_vect(void) __attribute__((weak));
+extern "C" void TIMER1_COMPA_vect(void) __attribute__((weak));
+extern "C" void PCINT0_vect(void) __attribute__((weak));
+extern "C" void PCINT1_vect(void) __attribute__((weak));
+extern "C" void PCINT2_vect(void) __attribute__((weak));
+
+//
+// =======================================================================================================
+// REGISTERS & VARIABLES
+// =======================================================================================================
+//
+
+volatile uint8_t SREG;
+volatile uint8_t ADMUX, ADCSRA, ADCSRB, DIDR0;
+volatile uint16_t ADC;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+volatile uint16_t TCNT1, OCR1A;
+volatile uint8_t TCCR2A, TCCR2B, OCR2A, OCR2B;
+volatile uint8_t PCICR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t PINB, PINC, PIND;
+
+uint64_t hostMicros;
+
+uint8_t hostPin[22];
+uint16_t hostAnalog[8];
+uint16_t hostVcc;
+
+std::string hostSerialOut;
+std::deque<uint8_t> hostSerialIn;
+int hostSerialSpace;
+
+uint8_t hostEeprom[1024];
+unsigned long hostEepromWrites;
+long hostEepromBudget = -1;
+
+std::vector<hostFrame> hostRadioSent;
+std::function<hostAck (const hostFrame &)> hostRadioPeer;
+
+uint8_t hostDisplay[8][128];
+unsigned long hostDisplayTransfers;
+
+std::vector<hostIrEdge> hostIrTrace;
+std::vector<hostLegoPacket> hostLegoTrace;
+
+HardwareSerial Serial;
+EEPROMClassEx EEPROM;
+SPIClass SPI;
+const uint8_t u8g_font_6x10[] = {0};
+uint8_t __stack; // top of the AVR stack (memory.h), the stack painting isn't executed on the host
+
+const uint8_t sregInterrupt = 0x80; // global interrupt enable (I flag)
+const uint32_t adcConversionTime = 104; // 13 ADC clocks @ 125kHz
+const uint32_t timer0OverflowTime = 1024; // millis() interrupt (64 x 256 clocks @ 16MHz, 1024us with 8MHz too)
+
+static bool adcBusy; // a conversion is running
+static uint64_t adcReady;
+static bool timer1Running;
+static uint64_t timer1Match;
+static bool irCarrier;
+static uint8_t pinOutput[22]; // pin is an output
+
+//
+// =======================================================================================================
+// SIMULATED TIME & INTERRUPTS
+// =======================================================================================================
+//
+
+static uint32_t timer1Period() {
+  static const uint16_t prescaler[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+  return (uint32_t)(OCR1A + 1) * prescaler[TCCR1B & 0x07] / (F_CPU / 1000000);
+}
+
+// Starts the conversions & timers, which were enabled by the sketch, and runs pending interrupts ----
+static void hostUpdate() {
+  if ((SREG & sregInterrupt) && (ADCSRA & _BV(ADIF)) && (ADCSRA & _BV(ADIE)) && ADC_vect) {
+    ADCSRA &= ~_BV(ADIF);
+    ADC_vect(); // the next conversion, which is started by the interrupt, is scheduled below
+  }
+
+  if ((ADCSRA & _BV(ADEN)) && (ADCSRA & _BV(ADSC)) && !adcBusy) {
+    adcBusy = true;
+    adcReady = hostMicros + adcConversionTime;
+  }
+
+  boolean timer1 = (TCCR1B & 0x07) && (TIMSK1 & _BV(OCIE1A));
+  if (timer1 && !timer1Running) timer1Match = hostMicros + timer1Period();
+  timer1Running = timer1;
+}
+
+static void adcComplete() {
+  adcBusy = false;
+  uint8_t channel = ADMUX & 0x0F;
+  if (channel < 8) ADC = hostAnalog[channel];
+  else if (channel == 0x0E) ADC = (1100UL * 1023 + hostVcc / 2) / hostVcc; // 1.1V reference, AVcc as reference
+  else ADC = 0;
+  ADCSRA = (ADCSRA & ~_BV(ADSC)) | _BV(ADIF);
+}
+
+static void timer1Compare() {
+  if (TIMER1_COMPA_vect && (SREG & sregInterrupt)) TIMER1_COMPA_vect();
+  timer1Match += timer1Period(); // CTC mode: the counter restarts with the match, the ISR sets the duration of this period
+
+  boolean carrier = (TCCR2A & _BV(COM2B1)) && (TCCR2B & 0x07);
+  if (carrier != irCarrier) {
+    irCarrier = carrier;
+    hostIrTrace.push_back({hostMicros, carrier});
+  }
+}
+
+static void hostRun(uint64_t until) {
+  for (;;) {
+    hostUpdate();
+    uint64_t next = until;
+    byte source = 0;
+    if (adcBusy && adcReady <= next) {
+      next = adcReady;
+      source = 1;
+    }
+    if (timer1Running && timer1Match < next) {
+      next = timer1Match;
+      source = 2;
+    }
+    if (source == 0) break;
+    hostMicros = next;
+    if (source == 1) adcComplete();
+    else timer1Compare();
+  }
+  hostMicros = until;
+}
+
+void hostAdvance(uint32_t microseconds) {
+  hostRun(hostMicros + microseconds);
+}
+
+unsigned long millis() {
+  return hostMicros / 1000;
+}
+
+unsigned long micros() {
+  return hostMicros;
+}
+
+void delay(unsigned long ms) {
+  hostRun(hostMicros + ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  hostRun(hostMicros + us);
+}
+
+void cli() {
+  SREG &= ~sregInterrupt;
+}
+
+void sei() {
+  SREG |= sregInterrupt;
+  hostUpdate();
+}
+
+// Idle sleep: wakes up with the next interrupt ----
+void sleep_cpu() {
+  uint64_t next = (hostMicros / timer0OverflowTime + 1) * timer0OverflowTime;
+  if (adcBusy && adcReady < next) next = adcReady;
+  if (timer1Running && timer1Match < next) next = timer1Match;
+  hostRun(next);
+}
+
+//
+// =======================================================================================================
+// PINS
+// =======================================================================================================
+//
+
+static void updatePorts() {
+  PIND = PINB = PINC = 0;
+  for (byte pin = 0; pin < 22; pin++) {
+    if (!hostPin[pin]) continue;
+    if (pin <= 7) PIND |= 1 << pin;
+    else if (pin <= 13) PINB |= 1 << (pin - 8);
+    else PINC |= 1 << (pin - 14);
+  }
+}
+
+void hostSetPin(uint8_t pin, uint8_t level) {
+  if (pin >= 22 || hostPin[pin] == level) return;
+  hostPin[pin] = level;
+  updatePorts();
+
+  if (!(SREG & sregInterrupt)) return;
+  if (pin <= 7 && (PCICR & _BV(2)) && (PCMSK2 & _BV(pin)) && PCINT2_vect) PCINT2_vect();
+  else if (pin >= 8 && pin <= 13 && (PCICR & _BV(0)) && (PCMSK0 & _BV(pin - 8)) && PCINT0_vect) PCINT0_vect();
+  else if (pin >= 14 && (PCICR & _BV(1)) && (PCMSK1 & _BV(pin - 14)) && PCINT1_vect) PCINT1_vect();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < 22) pinOutput[pin] = (mode == OUTPUT);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < 22 && pinOutput[pin]) {
+    hostPin[pin] = val ? HIGH : LOW;
+    updatePorts();
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < 22 ? hostPin[pin] : LOW;
+}
+
+int analogRead(uint8_t pin) {
+  if (pin >= A0) pin -= A0;
+  return pin < 8 ? hostAnalog[pin] : 0;
+}
+
+void analogWrite(uint8_t pin, int val) {
+  digitalWrite(pin, val >= 128);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+//
+// =======================================================================================================
+// PRINT & SERIAL
+// =======================================================================================================
+//
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::write(const char *str) {
+  return write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(const __FlashStringHelper *str) {
+  return write((const char *)str);
+}
+
+size_t Print::print(const char *str) {
+  return write(str);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(int n, int base) {
+  return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base) {
+  if (base != 10) return printNumber((uint32_t)n, base); // 32 bit, like on the AVR
+  if (n < 0) return print('-') + printNumber(-n, 10);
+  return printNumber(n, 10);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t Print::println() {
+  return write((const uint8_t *)"\r\n", 2);
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(long) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) base = 10;
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+  return write(str);
+}
+
+void HardwareSerial::begin(unsigned long baud) {}
+
+void HardwareSerial::end() {}
+
+int HardwareSerial::available() {
+  return hostSerialIn.size();
+}
+
+int HardwareSerial::read() {
+  if (hostSerialIn.empty()) return -1;
+  uint8_t c = hostSerialIn.front();
+  hostSerialIn.pop_front();
+  return c;
+}
+
+int HardwareSerial::availableForWrite() {
+  return hostSerialSpace;
+}
+
+void HardwareSerial::flush() {}
+
+size_t HardwareSerial::write(uint8_t c) {
+  hostSerialOut += (char)c;
+  return 1;
+}
+
+//
+// =======================================================================================================
+// EEPROM
+// =======================================================================================================
+//
+
+static void eepromWrite(int address, uint8_t value) {
+  if (address < 0 || address > E2END || hostEeprom[address] == value) return;
+  if (hostEepromBudget == 0) return; // power lost
+  if (hostEepromBudget > 0) hostEepromBudget--;
+  hostEeprom[address] = value;
+  hostEepromWrites++;
+}
+
+bool eeprom_is_ready() {
+  return true;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *address) {
+  return hostEeprom[(uintptr_t)address & E2END];
+}
+
+void eeprom_update_byte(uint8_t *address, uint8_t value) {
+  eepromWrite((uintptr_t)address, value);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n) {
+  for (size_t i = 0; i < n; i++) ((uint8_t *)dst)[i] = hostEeprom[((uintptr_t)src + i) & E2END];
+}
+
+int EEPROMClassEx::getAddress(int noOfBytes) {
+  int address = nextAddress;
+  nextAddress += noOfBytes;
+  return address;
+}
+
+uint8_t EEPROMClassEx::readByte(int address) {
+  return hostEeprom[address & E2END];
+}
+
+bool EEPROMClassEx::updateByte(int address, uint8_t value) {
+  eepromWrite(address, value);
+  return true;
+}
+
+//
+// =======================================================================================================
+// NRF24L01
+// =======================================================================================================
+//
+
+struct radioState {
+  bool listening = false;
+  uint8_t channel = 76;
+  uint8_t dataRate = RF24_1MBPS;
+  uint8_t paLevel = RF24_PA_MAX;
+  uint8_t retryDelay = 5; // (n + 1) x 250us
+  uint8_t retryCount = 15;
+  bool autoAck = true;
+  uint64_t writePipe = 0;
+  uint64_t readPipe[6] = {0, 0, 0, 0, 0, 0};
+
+  bool txPending = false; // a frame is in the air
+  uint64_t txDone = 0;
+  hostAck txResult;
+  uint8_t arc = 0; // auto retransmits of the last frame
+  bool ackAvailable = false;
+  uint8_t ackSize = 0;
+  uint8_t ack[32];
+
+  std::deque<hostFrame> rx; // RX FIFO (3 entries)
+  std::deque<hostAck> ackPayloads; // TX FIFO for the ACK payloads (3 entries)
+  bool rxValid = false; // a frame was received, duplicates of it are detected
+  hostFrame rxLast;
+  hostAck rxAck; // the ACK of the last received frame
+};
+static radioState rf;
+
+// Air time of one attempt (frame, turn around & ACK) in microseconds ----
+static uint32_t airTime(uint8_t size, uint8_t ackSize) {
+  uint32_t byteTime = rf.dataRate == RF24_250KBPS ? 32 : (rf.dataRate == RF24_2MBPS ? 4 : 8);
+  return 130 + (size + 9) * byteTime + 130 + (ackSize + 9) * byteTime; // 9 bytes: preamble, address, PCF, CRC
+}
+
+RF24::RF24(uint16_t cePin, uint16_t csnPin) {}
+
+bool RF24::begin() {
+  rf = radioState();
+  return true;
+}
+
+void RF24::powerUp() {}
+
+void RF24::powerDown() {}
+
+void RF24::printDetails() {
+  printf("RF24 stand-in: channel %d, data rate %d, PA level %d\n", rf.channel, rf.dataRate, rf.paLevel);
+}
+
+void RF24::setChannel(uint8_t channel) {
+  rf.channel = min(channel, (uint8_t)125);
+}
+
+uint8_t RF24::getChannel() {
+  return rf.channel;
+}
+
+void RF24::setPALevel(uint8_t level) {
+  rf.paLevel = level;
+}
+
+bool RF24::setDataRate(rf24_datarate_e speed) {
+  rf.dataRate = speed;
+  return true;
+}
+
+void RF24::setCRCLength(rf24_crclength_e length) {}
+
+void RF24::setAutoAck(bool enable) {
+  rf.autoAck = enable;
+}
+
+void RF24::setAutoAck(uint8_t pipe, bool enable) {
+  rf.autoAck = enable;
+}
+
+void RF24::enableAckPayload() {}
+
+void RF24::enableDynamicPayloads() {}
+
+void RF24::setRetries(uint8_t delay, uint8_t count) {
+  rf.retryDelay = min(delay, (uint8_t)15);
+  rf.retryCount = min(count, (uint8_t)15);
+}
+
+uint8_t RF24::getARC() {
+  return rf.arc;
+}
+
+void RF24::openWritingPipe(uint64_t address) {
+  rf.writePipe = address;
+}
+
+void RF24::openReadingPipe(uint8_t number, uint64_t address) {
+  if (number < 6) rf.readPipe[number] = address;
+}
+
+void RF24::startListening() {
+  rf.listening = true;
+  rf.txPending = false;
+}
+
+void RF24::stopListening() {
+  rf.listening = false;
+  rf.ackPayloads.clear();
+}
+
+bool RF24::startWrite(const void *buf, uint8_t len, const bool multicast) {
+  if (rf.listening) return false;
+
+  hostFrame frame;
+  frame.time = hostMicros;
+  frame.pipe = rf.writePipe;
+  frame.channel = rf.channel;
+  frame.dataRate = rf.dataRate;
+  frame.paLevel = rf.paLevel;
+  frame.size = min(len, (uint8_t)32);
+  memcpy(frame.data, buf, frame.size);
+  frame.retransmit = false;
+  hostRadioSent.push_back(frame);
+
+  hostAck result = {false, 0, 0, {0}};
+  if (hostRadioPeer) result = hostRadioPeer(frame);
+  if (multicast || !rf.autoAck) result = {true, 0, 0, {0}}; // no ACK expected
+  if (result.retries > rf.retryCount) result.ok = false;
+  if (!result.ok) result.retries = rf.retryCount;
+
+  uint32_t attempt = airTime(frame.size, result.ok ? result.size : 0);
+  uint32_t retransmit = max((uint32_t)(rf.retryDelay + 1) * 250, attempt);
+  rf.txPending = true;
+  rf.txDone = hostMicros + (uint64_t)result.retries * retransmit + attempt;
+  rf.txResult = result;
+  return true;
+}
+
+bool RF24::write(const void *buf, uint8_t len) {
+  if (!startWrite(buf, len, false)) return false;
+  hostRun(rf.txDone);
+  bool ok, fail, ready;
+  whatHappened(ok, fail, ready);
+  return ok;
+}
+
+void RF24::whatHappened(bool &tx_ok, bool &tx_fail, bool &rx_ready) {
+  tx_ok = tx_fail = false;
+  rx_ready = rf.listening && !rf.rx.empty();
+  if (!rf.txPending || hostMicros < rf.txDone) return;
+
+  rf.txPending = false;
+  rf.arc = rf.txResult.retries;
+  tx_ok = rf.txResult.ok;
+  tx_fail = !rf.txResult.ok;
+  if (tx_ok && rf.txResult.size > 0) {
+    rf.ackAvailable = true;
+    rf.ackSize = rf.txResult.size;
+    memcpy(rf.ack, rf.txResult.data, rf.ackSize);
+  }
+}
+
+uint8_t RF24::flush_tx() {
+  rf.txPending = false;
+  return 0;
+}
+
+bool RF24::isAckPayloadAvailable() {
+  return !rf.listening && rf.ackAvailable;
+}
+
+bool RF24::available() {
+  return available(NULL);
+}
+
+bool RF24::available(uint8_t *pipe_num) {
+  if (!rf.listening || rf.rx.empty()) return false;
+  if (pipe_num) {
+    *pipe_num = 0;
+    for (byte i = 0; i < 6; i++) {
+      if (rf.readPipe[i] == rf.rx.front().pipe) *pipe_num = i;
+    }
+  }
+  return true;
+}
+
+uint8_t RF24::getDynamicPayloadSize() {
+  if (rf.listening) return rf.rx.empty() ? 0 : rf.rx.front().size;
+  return rf.ackSize;
+}
+
+void RF24::read(void *buf, uint8_t len) {
+  if (rf.listening) {
+    if (rf.rx.empty()) return;
+    memcpy(buf, rf.rx.front().data, min(len, rf.rx.front().size));
+    rf.rx.pop_front();
+  }
+  else {
+    memcpy(buf, rf.ack, min(len, rf.ackSize));
+    rf.ackAvailable = false;
+  }
+}
+
+void RF24::writeAckPayload(uint8_t pipe, const void *buf, uint8_t len) {
+  if (rf.ackPayloads.size() >= 3) return; // TX FIFO full
+  hostAck ack = {true, 0, min(len, (uint8_t)32), {0}};
+  memcpy(ack.data, buf, ack.size);
+  rf.ackPayloads.push_back(ack);
+}
+
+bool hostRadioReceive(const hostFrame &frame, hostAck *ack) {
+  if (!rf.listening || frame.channel != rf.channel || frame.dataRate != rf.dataRate || rf.rx.size() >= 3) return false;
+
+  bool pipe = false;
+  for (byte i = 0; i < 6; i++) {
+    if (rf.readPipe[i] == frame.pipe) pipe = true;
+  }
+  if (!pipe) return false;
+
+  // Duplicate packet ID: the radio sends the ACK again, the payload is discarded
+  if (frame.retransmit && rf.rxValid && frame.pipe == rf.rxLast.pipe && frame.size == rf.rxLast.size &&
+      memcmp(frame.data, rf.rxLast.data, frame.size) == 0) {
+    if (ack) *ack = rf.rxAck;
+    return true;
+  }
+
+  rf.rx.push_back(frame);
+  rf.rx.back().time = hostMicros;
+
+  hostAck result = {true, 0, 0, {0}};
+  if (!rf.ackPayloads.empty()) {
+    result = rf.ackPayloads.front();
+    rf.ackPayloads.pop_front();
+  }
+  rf.rxValid = true;
+  rf.rxLast = frame;
+  rf.rxAck = result;
+  if (ack) *ack = result;
+  return true;
+}
+
+uint8_t hostRadioChannel() {
+  return rf.channel;
+}
+
+//
+// =======================================================================================================
+// OLED
+// =======================================================================================================
+//
+
+// The SSD1306 device: transfers the page, then clears the buffer ----
+static uint8_t hostDisplayDevice(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg) {
+  if (msg == U8G_DEV_MSG_PAGE_NEXT) {
+    u8g_pb_t *pb = (u8g_pb_t *)dev->dev_mem;
+    if (pb->p.page < 8) memcpy(hostDisplay[pb->p.page], pb->buf, pb->width);
+    hostDisplayTransfers++;
+  }
+  return u8g_dev_pb8v1_base_fn(u8g, dev, msg, arg);
+}
+
+uint8_t u8g_dev_pb8v1_base_fn(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg) {
+  u8g_pb_t *pb = (u8g_pb_t *)dev->dev_mem;
+  if (msg == U8G_DEV_MSG_PAGE_FIRST) pb->p.page = 0;
+  else if (msg == U8G_DEV_MSG_PAGE_NEXT) {
+    if (pb->p.page + 1 >= pb->p.total_height / pb->p.page_height) return 0;
+    pb->p.page++;
+  }
+  else return 1;
+
+  memset(pb->buf, 0, pb->width);
+  pb->p.page_y0 = pb->p.page * pb->p.page_height;
+  pb->p.page_y1 = pb->p.page_y0 + pb->p.page_height - 1;
+  return 1;
+}
+
+U8GLIB::U8GLIB() {
+  pb.p.page_height = 8;
+  pb.p.total_height = 64;
+  pb.p.page = 0;
+  pb.width = 128;
+  pb.buf = buf;
+  dev.dev_fn = hostDisplayDevice;
+  dev.dev_mem = &pb;
+  u8g.width = 128;
+  u8g.height = 64;
+  u8g.dev = &dev;
+  color = 1;
+  tx = ty = 0;
+}
+
+void U8GLIB::firstPage() {
+  u8g.dev->dev_fn(&u8g, u8g.dev, U8G_DEV_MSG_PAGE_FIRST, NULL);
+}
+
+uint8_t U8GLIB::nextPage() {
+  return u8g.dev->dev_fn(&u8g, u8g.dev, U8G_DEV_MSG_PAGE_NEXT, NULL);
+}
+
+// 6 x 10 "glyph": a bit pattern, which is different for every character ----
+size_t U8GLIB::write(uint8_t c) {
+  for (int col = 0; col < 5; col++) {
+    uint16_t pattern = (c * 0x9E37 >> (col * 3)) ^ (c << col);
+    for (int row = 0; row < 10; row++) {
+      if (pattern & (1 << row)) drawPixel(tx + col, ty + row);
+    }
+  }
+  tx += 6;
+  return 1;
+}
+
+void U8GLIB::drawStr(int x, int y, const char *s) {
+  setPrintPos(x, y);
+  print(s);
+}
+
+void U8GLIB::drawStr(int x, int y, const __FlashStringHelper *s) {
+  drawStr(x, y, (const char *)s);
+}
+
+void U8GLIB::drawPixel(int x, int y) {
+  int row = y - pb.p.page_y0;
+  if (x < 0 || x >= 128 || row < 0 || row >= 8) return;
+  if (color) buf[x] |= 1 << row;
+  else buf[x] &= ~(1 << row);
+}
+
+void U8GLIB::drawHLine(int x, int y, int w) {
+  for (int i = 0; i < w; i++) drawPixel(x + i, y);
+}
+
+void U8GLIB::drawVLine(int x, int y, int h) {
+  for (int i = 0; i < h; i++) drawPixel(x, y + i);
+}
+
+void U8GLIB::drawLine(int x1, int y1, int x2, int y2) {
+  int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+  int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+  int err = dx + dy;
+  for (;;) {
+    drawPixel(x1, y1);
+    if (x1 == x2 && y1 == y2) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x1 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y1 += sy;
+    }
+  }
+}
+
+void U8GLIB::drawFrame(int x, int y, int w, int h) {
+  drawHLine(x, y, w);
+  drawHLine(x, y + h - 1, w);
+  drawVLine(x, y, h);
+  drawVLine(x + w - 1, y, h);
+}
+
+void U8GLIB::drawBox(int x, int y, int w, int h) {
+  for (int i = 0; i < h; i++) drawHLine(x, y + i, w);
+}
+
+void U8GLIB::drawCircle(int x0, int y0, int rad, uint8_t option) {
+  for (int y = -rad; y <= rad; y++) {
+    for (int x = -rad; x <= rad; x++) {
+      int d = x * x + y * y;
+      if (d <= rad * rad && d > (rad - 1) * (rad - 1)) drawPixel(x0 + x, y0 + y);
+    }
+  }
+}
+
+void U8GLIB::drawDisc(int x0, int y0, int rad, uint8_t option) {
+  for (int y = -rad; y <= rad; y++) {
+    for (int x = -rad; x <= rad; x++) {
+      if (x * x + y * y <= rad * rad) drawPixel(x0 + x, y0 + y);
+    }
+  }
+}
+
+//
+// =======================================================================================================
+// LEGO IR
+// =======================================================================================================
+//
+
+void LegoIr::combo_pwm(uint8_t blue, uint8_t red) {
+  hostLegoTrace.push_back({hostMicros, red, blue});
+}
+
+//
+// =======================================================================================================
+// POWER ON STATE
+// =======================================================================================================
+//
+
+void hostReset() {
+  SREG = sregInterrupt; // enabled by the Arduino core before setup()
+  ADMUX = ADCSRB = DIDR0 = 0;
+  ADCSRA = _BV(ADPS2) | _BV(ADPS1); // prescaler 64 (Arduino core, 8MHz)
+  ADC = 0;
+  TCCR1A = TCCR1B = TIMSK1 = TIFR1 = 0;
+  TCNT1 = OCR1A = 0;
+  TCCR2A = TCCR2B = OCR2A = OCR2B = 0;
+  PCICR = PCMSK0 = PCMSK1 = PCMSK2 = 0;
+  adcBusy = timer1Running = irCarrier = false;
+
+  for (byte pin = 0; pin < 22; pin++) {
+    hostPin[pin] = HIGH; // pull ups
+    pinOutput[pin] = false;
+  }
+  updatePorts();
+  for (byte i = 0; i < 8; i++) hostAnalog[i] = 512;
+  hostVcc = 3300;
+
+  hostSerialOut.clear();
+  hostSerialIn.clear();
+  hostSerialSpace = 63;
+
+  rf = radioState();
+  hostRadioSent.clear();
+  hostRadioPeer = nullptr;
+
+  memset(hostDisplay, 0, sizeof(hostDisplay));
+  hostDisplayTransfers = 0;
+  hostIrTrace.clear();
+  hostLegoTrace.clear();
+}
+
+// Power on: the EEPROM is erased (0xFF), the rest of the hardware is reset ----
+static struct hostPowerOn {
+  hostPowerOn() {
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    hostReset();
+  }
+} hostPowerOnState;
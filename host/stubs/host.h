@@ -0,0 +1,117 @@
+/*
+  Host simulation of the "Micro RC" transmitter hardware (Linux / g++ build, see "host/Makefile")
+  The library stand-ins in this directory are working models of the AVR registers, the ADC, Timer 1 & 2, the
+  pin change interrupts, the EEPROM, the NRF24L01, the OLED and the IR transmitters. The time is simulated: it
+  only advances in delay(), delayMicroseconds(), the idle sleep and hostAdvance(). The interrupts, which are due
+  in this time, are executed in the right order (ADC conversion every 104us, Timer 1 compare match).
+  Created by TheDIYGuy999
+*/
+
+#ifndef host_h
+#define host_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+
+//
+// =======================================================================================================
+// CLOCK
+// =======================================================================================================
+//
+
+extern uint64_t hostMicros; // simulated time since power on in microseconds
+
+void hostAdvance(uint32_t microseconds); // let the time pass and run the due interrupts
+void hostReset(); // power on state of all simulated hardware (registers, pins, radio, display, Serial)
+
+//
+// =======================================================================================================
+// INPUTS
+// =======================================================================================================
+//
+
+extern uint8_t hostPin[22]; // digital input levels of pin 0 - 21 (the buttons are active LOW)
+extern uint16_t hostAnalog[8]; // A0 - A7, 0 - 1023
+extern uint16_t hostVcc; // supply voltage in mV (the 1.1V reference channel is converted with it)
+
+void hostSetPin(uint8_t pin, uint8_t level); // change an input, fires the pin change interrupt
+
+//
+// =======================================================================================================
+// SERIAL
+// =======================================================================================================
+//
+
+extern std::string hostSerialOut; // everything written via Serial
+extern std::deque<uint8_t> hostSerialIn; // bytes, which are received by Serial
+extern int hostSerialSpace; // free bytes in the TX buffer (Serial.availableForWrite())
+
+//
+// =======================================================================================================
+// EEPROM
+// =======================================================================================================
+//
+
+extern uint8_t hostEeprom[1024];
+extern unsigned long hostEepromWrites; // number of byte writes (wear)
+extern long hostEepromBudget; // byte writes until the power is lost (< 0 = never). Later writes are ignored
+
+//
+// =======================================================================================================
+// NRF24L01
+// =======================================================================================================
+//
+
+struct hostFrame {
+  uint64_t time; // start of the transmission
+  uint64_t pipe; // address
+  uint8_t channel;
+  uint8_t dataRate; // rf24_datarate_e
+  uint8_t paLevel; // rf24_pa_dbm_e
+  uint8_t size;
+  uint8_t data[32];
+  bool retransmit; // auto retransmit of the previous frame (same packet ID), the ACK was lost
+};
+
+struct hostAck {
+  bool ok; // the receiver has acknowledged the frame
+  uint8_t retries; // lost attempts before the ACK (the radio gives up after the configured count)
+  uint8_t size; // ACK payload size (0 = empty ACK)
+  uint8_t data[32];
+};
+
+extern std::vector<hostFrame> hostRadioSent; // all frames sent in transmitter mode
+extern std::function<hostAck (const hostFrame &)> hostRadioPeer; // the receiver (empty: nobody is listening)
+
+// A frame in the air for the radio in receiver mode (radio tester). Returns true, if the radio is listening on
+// the channel & pipe of the frame and the RX FIFO is not full. The ACK payload is returned in "ack", if not NULL.
+// A retransmitted frame is acknowledged again with the same ACK payload, but not stored in the RX FIFO
+bool hostRadioReceive(const hostFrame &frame, hostAck *ack = NULL);
+uint8_t hostRadioChannel(); // the current channel of the radio
+
+//
+// =======================================================================================================
+// OLED & IR
+// =======================================================================================================
+//
+
+extern uint8_t hostDisplay[8][128]; // the pages, which were transferred to the display
+extern unsigned long hostDisplayTransfers; // number of transferred pages
+
+struct hostIrEdge {
+  uint64_t time;
+  bool carrier; // 38kHz carrier on pin 3 switched ON / OFF
+};
+extern std::vector<hostIrEdge> hostIrTrace; // MECCANO IR (Timer 2 carrier)
+
+struct hostLegoPacket {
+  uint64_t time;
+  uint8_t red, blue; // PWM steps
+};
+extern std::vector<hostLegoPacket> hostLegoTrace; // LEGO Powerfunctions IR packets
+
+#endif
@@ -0,0 +1,11 @@
+/*
+  printf stand-in for the host build (printf() writes to stdout anyway)
+  Created by TheDIYGuy999
+*/
+
+#ifndef __PRINTF_H__
+#define __PRINTF_H__
+
+inline void printf_begin() {}
+
+#endif
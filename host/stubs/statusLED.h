@@ -0,0 +1,20 @@
+/*
+  statusLED stand-in for the host build (no output)
+  Created by TheDIYGuy999
+*/
+
+#ifndef statusLED_h
+#define statusLED_h
+
+#include "Arduino.h"
+
+class statusLED {
+  public:
+    statusLED(bool inverse) {}
+    void begin(int pin) {}
+    void on() {}
+    void off() {}
+    void flash(unsigned long onDuration, unsigned long offDuration, unsigned long pauseDuration, int pulses, int delay = 0) {}
+};
+
+#endif
@@ -0,0 +1,63 @@
+/*
+  Minimal test helpers for the host build (see Makefile). Each test includes the sketch with its build options:
+
+    #define PACKED_PROTOCOL
+    #include "sketch.cpp"
+    #include "test.h"
+
+  Created by TheDIYGuy999
+*/
+
+#ifndef test_h
+#define test_h
+
+int testFailures = 0;
+
+#define CHECK(condition) testCheck((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected) testEqual((long)(actual), (long)(expected), #actual, __FILE__, __LINE__)
+
+void testCheck(bool ok, const char *text, const char *file, int line) {
+  if (ok) return;
+  printf("%s:%d: CHECK(%s) failed\n", file, line, text);
+  testFailures++;
+}
+
+void testEqual(long actual, long expected, const char *text, const char *file, int line) {
+  if (actual == expected) return;
+  printf("%s:%d: %s is %ld, expected %ld\n", file, line, text, actual, expected);
+  testFailures++;
+}
+
+// Run the main loop for the given simulated time (the loop sleeps itself, if there is nothing to do) ----
+void testRun(unsigned long ms) {
+  uint64_t end = hostMicros + ms * 1000ULL;
+  while (hostMicros < end) {
+    loop();
+    hostAdvance(10);
+  }
+}
+
+// Moving joysticks: the potentiometer channels of the transmitter profile (see transmitterConfig.h) ----
+void testMove(int i) {
+  const byte pins[4] = {JOYSTICK_1, JOYSTICK_2, JOYSTICK_3, JOYSTICK_4};
+  for (byte ch = 0; ch < 4; ch++) {
+    if (hasPot(ch)) hostAnalog[pins[ch] - A0] = 300 + (i * 7 + ch * 50) % 400;
+  }
+}
+
+// Joysticks at rest ----
+void testRest() {
+  for (byte pin = 0; pin < 4; pin++) hostAnalog[pin] = 512;
+}
+
+// Frames sent since "start" (index in hostRadioSent) ----
+unsigned long testFrames(size_t start) {
+  return hostRadioSent.size() - start;
+}
+
+int testResult(const char *name) {
+  printf("%s: %s\n", name, testFailures ? "FAILED" : "passed");
+  return testFailures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+  Host build smoke test: setup() & the main loop with the default build options. A receiver acknowledges every
+  frame. Moving joysticks are sent with the full frame rate (200Hz), keep-alive frames within the receiver's search timeout (see power.h).
+  Created by TheDIYGuy999
+*/
+
+#include "sketch.cpp"
+#include "test.h"
+
+int main() {
+  hostRadioPeer = [](const hostFrame & frame) { // legacy receiver with 7.4V vehicle battery
+    ackPayload legacy;
+    legacy.vcc = 3.3;
+    legacy.batteryVoltage = 7.4;
+    legacy.batteryOk = true;
+    legacy.channel = frame.channel;
+    hostAck ack = {true, 0, sizeof(ackPayload), {0}};
+    memcpy(ack.data, &legacy, sizeof(ackPayload));
+    return ack;
+  };
+  setup();
+  CHECK_EQUAL(operationMode, 0);
+  CHECK_EQUAL(transmissionMode, 1);
+
+  // Moving joysticks: every control task pass sends a frame
+  size_t start = hostRadioSent.size();
+  for (int i = 0; i < 100; i++) {
+    testMove(i);
+    testRun(10);
+  }
+  unsigned long frames = testFrames(start);
+  CHECK(frames >= 190 && frames <= 201);
+  CHECK(transmissionState);
+  CHECK_EQUAL(payload.batteryVoltage, 7400);
+
+  // Joysticks at rest: keep-alive frames after 1s
+  testRun(1500);
+  start = hostRadioSent.size();
+  testRun(1000);
+  frames = testFrames(start);
+  CHECK(frames >= 1000 / (powerKeepAlive + 5) && frames <= 1000 / powerKeepAlive + 1); // control task every 5ms
+  CHECK(transmissionState);
+
+  // Every channel of the hop sequence gets a frame within the search timeout of the receiver
+  uint64_t gapMax = 0;
+  for (size_t i = start + hopSequenceLength; i < hostRadioSent.size(); i++) {
+    CHECK_EQUAL(hostRadioSent[i].channel, hostRadioSent[i - hopSequenceLength].channel);
+    gapMax = max(gapMax, hostRadioSent[i].time - hostRadioSent[i - hopSequenceLength].time);
+  }
+  CHECK(gapMax < hopSearchTimeout * 1000);
+
+  // One change in the keep-alive state: the latency from the ADC scan until the ACK of its frame
+  CHECK(power.latencyAvg[POWER_ACTIVE] > 0 && power.latencyMax[POWER_ACTIVE] < 10000);
+  testMove(0);
+  testRun(1000);
+  CHECK(power.latencyMax[POWER_IDLE] > 0 && power.latencyMax[POWER_IDLE] < 10000);
+
+  // The frames are sent to vehicle 1
+  CHECK(hostRadioSent.back().pipe == pgm_read_64(&pipeOut, 0));
+  CHECK_EQUAL(hostRadioSent.back().size, sizeof(RcData));
+
+  // No receiver: the link is lost after 1s
+  hostRadioPeer = nullptr;
+  testRun(1500);
+  CHECK(!transmissionState);
+
+  // Back from an IR mode: the radio setup doesn't wait for a frame in the air
+  uint64_t now = hostMicros;
+  start = hostRadioSent.size();
+  setupRadio();
+  CHECK_EQUAL(hostMicros - now, 0);
+  CHECK_EQUAL(testFrames(start), 0);
+  testRun(50);
+  CHECK(testFrames(start) >= 1); // keep-alive frame of transmitRadio()
+
+  return testResult("frames");
+}
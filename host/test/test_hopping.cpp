@@ -0,0 +1,119 @@
+/*
+  Frequency hopping (see hopping.h): a noisy channel is replaced by the spare channel of its slot, and the
+  receiver (radio tester mode) still receives the auto retransmits of a frame, if its ACK was lost
+  Created by TheDIYGuy999
+*/
+
+#define PACKED_PROTOCOL
+#include "sketch.cpp"
+#include "test.h"
+
+const byte noisyChannel = 2; // primary channel of slot 1
+uint32_t noise = 1; // deterministic pseudo random numbers
+
+byte noiseNext() {
+  noise = noise * 1103515245 + 12345;
+  return (noise >> 16) % 100;
+}
+
+unsigned long peerFrames, peerAcks;
+
+// Packed receiver: every attempt on the noisy channel is lost with 85%, on the other channels with 1% ----
+hostAck noisyPeer(const hostFrame &frame) {
+  byte loss = frame.channel == noisyChannel ? 85 : 1;
+  hostAck ack = {false, 0, packedAckSize, {0}};
+  for (byte attempt = 0; attempt <= 5 && !ack.ok; attempt++) { // setRetries(5, 5)
+    if (noiseNext() >= loss) ack.ok = true;
+    else ack.retries++;
+  }
+
+  byte pos = 62; // data rate request, after the axes, switches, pot1 & hop mask
+  byte rateRequest = getBits(frame.data, pos, 2); // confirmed in the ACK
+  pos = 8;
+  ack.data[0] = packedHeader(frame.data[0] & 0x0F);
+  putBits(ack.data, pos, 3300, 16);
+  putBits(ack.data, pos, 7400, 16);
+  putBits(ack.data, pos, frame.channel, 8);
+  putBits(ack.data, pos, 1, 1);
+  putBits(ack.data, pos, rateRequest, 2);
+
+  peerFrames++;
+  if (ack.ok) peerAcks++;
+  return ack;
+}
+
+// A packed frame of the transmitter in the air ----
+hostFrame airFrame(byte sequence, boolean retransmit) {
+  hostFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  txSequence = sequence;
+  hopMask = 0;
+  frame.time = hostMicros;
+  frame.pipe = pgm_read_64(&pipeOut, vehicleNumber - 1);
+  frame.channel = hopTable[sequence & (hopSlots - 1)][0];
+  frame.dataRate = RF24_250KBPS;
+  frame.size = encodeRcData(frame.data);
+  frame.retransmit = retransmit;
+  return frame;
+}
+
+int main() {
+
+  // Receiver: the ACK of frame 0 is lost, the retransmit is received on the same channel ----
+  operationMode = 1;
+  setupRadio();
+  CHECK_EQUAL(hostRadioChannel(), hopTable[0][0]);
+
+  CHECK(hostRadioReceive(airFrame(0, false)));
+  readRadio();
+  CHECK_EQUAL(hostRadioChannel(), hopTable[0][0]); // hold time
+
+  hostAdvance(1500); // auto retransmit delay
+  hostAck ack;
+  CHECK(hostRadioReceive(airFrame(0, true), &ack));
+  CHECK(ack.ok);
+  CHECK(!radio.available()); // the duplicate is not stored
+  readRadio();
+  CHECK_EQUAL(hostRadioChannel(), hopTable[0][0]);
+
+  hostAdvance(hopFollowHold - 1500 + 10);
+  readRadio();
+  CHECK_EQUAL(hostRadioChannel(), hopTable[1][0]); // ready for the next frame (5ms)
+
+  hostAdvance(1000);
+  CHECK(hostRadioReceive(airFrame(1, false)));
+  readRadio();
+  CHECK_EQUAL(rxSequence, 1);
+
+  // Transmitter with a noisy channel: slot 1 is switched to its spare channel ----
+  hostReset();
+  operationMode = 0;
+  hostRadioPeer = noisyPeer;
+  setup();
+  CHECK_EQUAL(operationMode, 0);
+
+  for (int i = 0; i < 1000; i++) { // 10s with moving joysticks (200 frames/s)
+    testMove(i);
+    testRun(10);
+  }
+  CHECK(hopMask & 0x02);
+  CHECK_EQUAL(hopChannel(1), hopTable[1][1]);
+  CHECK(transmissionState);
+  unsigned long lostBefore = peerFrames - peerAcks;
+
+  size_t start = hostRadioSent.size();
+  peerFrames = peerAcks = 0;
+  for (int i = 0; i < 500; i++) {
+    testMove(i);
+    testRun(10);
+  }
+  unsigned long noisy = 0;
+  for (size_t i = start; i < hostRadioSent.size(); i++) {
+    if (hostRadioSent[i].channel == noisyChannel) noisy++;
+  }
+  CHECK_EQUAL(noisy, 0);
+  CHECK(peerFrames > 0 && peerAcks * 100 >= peerFrames * 99);
+  CHECK(peerFrames - peerAcks < lostBefore / 2); // 5s without the noisy channel, 10s before
+
+  return testResult("hopping");
+}
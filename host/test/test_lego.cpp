@@ -0,0 +1,52 @@
+/*
+  LEGO Powerfunctions IR: speed steps with hysteresis, one packet for both channels, keep-alive every 600ms
+  Created by TheDIYGuy999
+*/
+
+#include "sketch.cpp"
+#include "test.h"
+
+// Call transmitLegoIr() every 5ms (control task), returns the number of sent packets ----
+size_t run(unsigned long ms) {
+  size_t start = hostLegoTrace.size();
+  for (unsigned long t = 0; t < ms; t += 5) {
+    transmitLegoIr();
+    hostAdvance(5000);
+  }
+  return hostLegoTrace.size() - start;
+}
+
+int main() {
+  data.axis2 = 50;
+  data.axis3 = 50;
+  CHECK_EQUAL(run(1000), 1); // keep-alive only
+  CHECK_EQUAL(hostLegoTrace.back().red, PWM_BRK);
+  CHECK_EQUAL(hostLegoTrace.back().blue, PWM_BRK);
+
+  // A step is changed, after the joystick has passed the boundary (58) by the hysteresis
+  data.axis3 = 59;
+  CHECK_EQUAL(run(100), 0);
+  data.axis3 = 60;
+  CHECK_EQUAL(run(100), 1);
+  CHECK_EQUAL(hostLegoTrace.back().red, PWM_FWD1);
+  CHECK_EQUAL(hostLegoTrace.back().blue, PWM_BRK);
+  data.axis3 = 56;
+  CHECK_EQUAL(run(100), 0);
+  data.axis3 = 55;
+  CHECK_EQUAL(run(100), 1);
+  CHECK_EQUAL(hostLegoTrace.back().red, PWM_BRK);
+
+  // Both channels changed in the same pass: one packet
+  data.axis2 = 0;
+  data.axis3 = 100;
+  CHECK_EQUAL(run(5), 1);
+  CHECK_EQUAL(hostLegoTrace.back().red, PWM_FWD7);
+  CHECK_EQUAL(hostLegoTrace.back().blue, PWM_REV7);
+
+  // No change: one keep-alive packet every 600ms
+  size_t start = hostLegoTrace.size();
+  CHECK_EQUAL(run(3000), 5);
+  for (size_t i = start + 1; i < hostLegoTrace.size(); i++) CHECK_EQUAL(hostLegoTrace[i].time - hostLegoTrace[i - 1].time, 600000);
+
+  return testResult("lego");
+}
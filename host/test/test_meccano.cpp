@@ -0,0 +1,140 @@
+/*
+  MECCANO IR: the pulses of the Timer 1 / Timer 2 generator are compared with the former pulse tables (V1.2 of
+  MeccanoIr.h, one table per command, ON / OFF in 10's of microseconds). A frame is followed by 30ms pause.
+  A waiting command is replaced by a newer one of the same motor, so the motor always gets the latest state.
+  Created by TheDIYGuy999
+*/
+
+#include "sketch.cpp"
+#include "test.h"
+
+const byte referenceSteps = 28;
+const byte reference[12][referenceSteps] = {
+  {180, 180, 30, 60, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 120, 240}, // A+
+  {180, 180, 30, 30, 30, 60, 30, 60, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 30, 60, 30, 30, 30, 30, 30, 30, 120, 240}, // A-
+  {180, 180, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 120, 240}, // A OFF
+  {180, 180, 30, 60, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 120, 240}, // B+
+  {180, 180, 30, 30, 30, 60, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 60, 30, 30, 30, 30, 120, 240}, // B-
+  {180, 180, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 120, 240}, // B OFF
+  {180, 180, 30, 60, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 120, 240}, // C+
+  {180, 180, 30, 30, 30, 60, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 60, 30, 30, 120, 240}, // C-
+  {180, 180, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 120, 240}, // C OFF
+  {180, 180, 30, 60, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 30, 60, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 120, 240}, // D+
+  {180, 180, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 60, 120, 240}, // D-
+  {180, 180, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 60, 120, 240}  // D OFF
+};
+
+// Wait, until the queue is empty and the generator is stopped ----
+void waitIdle() {
+  for (int i = 0; i < 1000 && irActive; i++) hostAdvance(1000);
+}
+
+// The command of a frame in the trace (0 = no match) ----
+byte traceCommand(size_t frame) {
+  if ((frame + 1) * referenceSteps > hostIrTrace.size()) return 0;
+  for (byte command = 1; command <= meccanoCommands; command++) {
+    boolean match = true;
+    for (byte step = 0; step < referenceSteps - 1; step++) {
+      size_t i = frame * referenceSteps + step;
+      if (hostIrTrace[i + 1].time - hostIrTrace[i].time != reference[command - 1][step] * 10) match = false;
+    }
+    if (match) return command;
+  }
+  return 0;
+}
+
+// One control task pass in MECCANO mode, then 5ms ----
+void controlPass(byte axis1, byte axis2, byte axis3, byte axis4) {
+  data.axis1 = axis1;
+  data.axis2 = axis2;
+  data.axis3 = axis3;
+  data.axis4 = axis4;
+  transmitMeccanoIr();
+  hostAdvance(5000);
+}
+
+int main() {
+
+  // Every command, one by one: the steps are the durations between the carrier edges
+  for (byte command = 1; command <= meccanoCommands; command++) {
+    hostIrTrace.clear();
+    buildIrSignal(command);
+    CHECK(irActive);
+    CHECK_EQUAL(OCR2A, 25); // 38.5kHz @ 8MHz
+    CHECK_EQUAL(OCR2B, 12); // 50% duty cycle
+    waitIdle();
+    CHECK(!irActive);
+    CHECK_EQUAL(hostIrTrace.size(), referenceSteps);
+    if (hostIrTrace.size() != referenceSteps) continue;
+
+    for (byte step = 0; step < referenceSteps - 1; step++) {
+      CHECK_EQUAL(hostIrTrace[step].carrier, step % 2 == 0);
+      CHECK_EQUAL(hostIrTrace[step + 1].time - hostIrTrace[step].time, reference[command - 1][step] * 10);
+    }
+  }
+
+  // Queued commands: the trailer space and the 30ms pause are between the frames, duplicates are ignored
+  hostIrTrace.clear();
+  buildIrSignal(1);
+  buildIrSignal(5);
+  buildIrSignal(5); // still waiting in the queue
+  buildIrSignal(0); // invalid
+  buildIrSignal(13);
+  waitIdle();
+  CHECK_EQUAL(hostIrTrace.size(), 2 * referenceSteps);
+  if (hostIrTrace.size() == 2 * referenceSteps) {
+    CHECK_EQUAL(hostIrTrace[referenceSteps].time - hostIrTrace[referenceSteps - 1].time, 2400 + irFrameGap);
+    for (byte step = 0; step < referenceSteps - 1; step++) {
+      CHECK_EQUAL(hostIrTrace[referenceSteps + step + 1].time - hostIrTrace[referenceSteps + step].time, reference[4][step] * 10);
+    }
+  }
+
+  // All commands in a row: one waiting command per motor, the latest one (OFF) is sent
+  hostIrTrace.clear();
+  for (byte command = 1; command <= meccanoCommands; command++) buildIrSignal(command);
+  waitIdle();
+  CHECK_EQUAL(hostIrTrace.size(), 4 * referenceSteps);
+  CHECK_EQUAL(traceCommand(0), 3); // A OFF
+  CHECK_EQUAL(traceCommand(1), 6); // B OFF
+  CHECK_EQUAL(traceCommand(2), 9); // C OFF
+  CHECK_EQUAL(traceCommand(3), 12); // D OFF
+
+  // Flick and centre (a frame takes about 46ms): the last frame of motor A is "A OFF"
+  hostIrTrace.clear();
+  controlPass(100, 50, 50, 50); // A+ is sent
+  controlPass(50, 50, 50, 50); // A OFF is waiting
+  controlPass(100, 50, 50, 50); // A+ replaces it
+  controlPass(50, 50, 50, 50); // A OFF replaces it
+  for (int i = 0; i < 40; i++) controlPass(50, 50, 50, 50);
+  waitIdle();
+  CHECK_EQUAL(hostIrTrace.size(), 2 * referenceSteps);
+  CHECK_EQUAL(traceCommand(0), 1); // A+
+  CHECK_EQUAL(traceCommand(1), 3); // A OFF
+
+  // Quick movements on all channels: every motor gets its OFF command at the end
+  hostIrTrace.clear();
+  for (int i = 0; i < 10; i++) {
+    controlPass(100, 0, 100, 0);
+    controlPass(0, 100, 0, 100);
+  }
+  for (int i = 0; i < 100; i++) controlPass(50, 50, 50, 50);
+  waitIdle();
+  byte last[4] = {0, 0, 0, 0};
+  for (size_t frame = 0; traceCommand(frame); frame++) last[(traceCommand(frame) - 1) / 3] = traceCommand(frame);
+  CHECK_EQUAL(last[0], 3);
+  CHECK_EQUAL(last[1], 6);
+  CHECK_EQUAL(last[2], 9);
+  CHECK_EQUAL(last[3], 12);
+  CHECK_EQUAL(hostIrTrace.size() % referenceSteps, 0);
+
+  // B, C & D deflected: no commands for motor A
+  hostIrTrace.clear();
+  for (int i = 0; i < 100; i++) controlPass(50, 0, 0, 0);
+  for (int i = 0; i < 20; i++) controlPass(50, 50, 50, 50);
+  waitIdle();
+  size_t frames = 0;
+  for (; traceCommand(frames); frames++) CHECK(traceCommand(frames) > 3);
+  CHECK(frames > 0);
+
+  return testResult("meccano");
+}
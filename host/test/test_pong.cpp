@@ -0,0 +1,135 @@
+/*
+  Pong physics (see pong.h): the result only depends on the player input (not on the call timing), the paddle
+  collision is tested along the path of the ball, so a fast ball doesn't tunnel through a paddle
+  Created by TheDIYGuy999
+*/
+
+#include "sketch.cpp"
+#include "test.h"
+
+void pongReset() {
+  ball_x = 64 * PONG_FIX;
+  ball_y = 32 * PONG_FIX;
+  ball_speed_x = -BALL_SPEED;
+  ball_speed_y = BALL_SPEED;
+  cpu_y = player_y = 16 * PONG_FIX;
+  center = false;
+  cpu_points = player_points = 0;
+  cpu_won = player_won = false;
+}
+
+// All state variables of the game ----
+std::vector<int> pongState() {
+  return {ball_x, ball_y, ball_speed_x, ball_speed_y, cpu_y, player_y, center, cpu_points, player_points, cpu_won, player_won};
+}
+
+// Player paddle input (0 - 100), which places the paddle center at "y" (pixels) ----
+uint8_t pongInput(int y) {
+  for (uint8_t input = 0; input <= 100; input++) {
+    if (map(input, 100, 0, 0, (63 - PADDLE_HEIGHT)) + half_paddle <= y) return input;
+  }
+  return 0;
+}
+
+// Runs the ball towards the player paddle, until it's reflected or behind the paddle. Returns true for a hit ----
+boolean playerHit(int x, int y, int speed_x, int speed_y) {
+  pongReset();
+  ball_x = x;
+  ball_y = y;
+  ball_speed_x = speed_x;
+  ball_speed_y = speed_y;
+  int crossing = y + (long)speed_y * (PLAYER_X * PONG_FIX - x) / speed_x; // the paddle is waiting there
+  uint8_t input = pongInput(crossing / PONG_FIX);
+  player_y = map(input, 100, 0, 0, (63 - PADDLE_HEIGHT)) * PONG_FIX;
+  for (int i = 0; i < 100; i++) {
+    pongStep(input);
+    if (ball_speed_x < 0) return ball_x <= PLAYER_X * PONG_FIX;
+    if (ball_x > PLAYER_X * PONG_FIX) return false;
+  }
+  return false;
+}
+
+int main() {
+  setup();
+  data.axis1 = data.axis2 = 50;
+
+  // The same inputs give the same game ----
+  uint32_t noise = 1;
+  std::vector<int> first;
+  for (byte run = 0; run < 2; run++) {
+    pongReset();
+    noise = 1;
+    for (int i = 0; i < 20000; i++) { // 100s
+      noise = noise * 1103515245 + 12345;
+      pongStep((noise >> 16) % 101);
+    }
+    if (run == 0) first = pongState();
+  }
+  CHECK(first == pongState());
+  CHECK(cpu_points + player_points > 0);
+
+  // The call timing (display throughput) doesn't change the result ----
+  std::vector<int> timed[2];
+  const uint32_t interval[2] = {1000, 7000}; // us between two pong() calls
+  for (byte run = 0; run < 2; run++) {
+    pong();
+    pongReset();
+    uint64_t end = hostMicros + 2000000;
+    while (hostMicros + interval[run] <= end) {
+      hostAdvance(interval[run]);
+      pong();
+    }
+    hostAdvance(end - hostMicros);
+    pong();
+    timed[run] = pongState();
+  }
+  CHECK(timed[0] == timed[1]);
+  CHECK(timed[0][0] != 64 * PONG_FIX || timed[0][1] != 32 * PONG_FIX); // 400 steps done
+
+  // A hit at the paddle: reflected, faster, the angle depends on the hit position ----
+  CHECK(playerHit(100 * PONG_FIX, 30 * PONG_FIX, BALL_SPEED, 0));
+  CHECK_EQUAL(ball_speed_x, -(BALL_SPEED + BALL_SPEED / 16));
+  CHECK(playerHit(100 * PONG_FIX, 34 * PONG_FIX, BALL_SPEED, BALL_SPEED));
+  CHECK(ball_speed_y != BALL_SPEED);
+
+  // No tunneling: every speed, angle and start position up to the max. speed (more than 1 pixel per step) ----
+  unsigned long missed = 0, tests = 0;
+  for (int speed = BALL_SPEED; speed <= BALL_SPEED_MAX; speed += 3) {
+    for (int speed_y = -speed; speed_y <= speed; speed_y += speed / 4) {
+      for (int x = 112 * PONG_FIX; x < 112 * PONG_FIX + speed; x += 5) { // one step of start positions
+        tests++;
+        if (!playerHit(x, 32 * PONG_FIX, speed, speed_y)) missed++;
+      }
+    }
+  }
+  CHECK(tests > 1000);
+  CHECK_EQUAL(missed, 0);
+
+  // Paddle away: the ball passes, the CPU gets a point ----
+  pongReset();
+  ball_x = 100 * PONG_FIX;
+  ball_y = 10 * PONG_FIX;
+  ball_speed_x = BALL_SPEED_MAX;
+  ball_speed_y = 0;
+  center = true;
+  for (int i = 0; i < 20; i++) pongStep(0); // paddle at the bottom
+  CHECK_EQUAL(cpu_points, 1);
+  CHECK_EQUAL(abs(ball_speed_x), BALL_SPEED); // start speed again
+
+  // The CPU paddle reflects the fast ball as well ----
+  pongReset();
+  ball_x = 30 * PONG_FIX;
+  ball_y = 32 * PONG_FIX;
+  ball_speed_x = -BALL_SPEED_MAX;
+  ball_speed_y = 0;
+  cpu_y = (32 - half_paddle) * PONG_FIX;
+  boolean reflected = false;
+  for (int i = 0; i < 30 && !reflected; i++) {
+    pongStep(50);
+    reflected = ball_speed_x > 0;
+  }
+  CHECK(reflected);
+  CHECK(ball_x >= CPU_X * PONG_FIX);
+
+  return testResult("pong");
+}
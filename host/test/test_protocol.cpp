@@ -0,0 +1,133 @@
+/*
+  Radio protocol: packed frames & ACK payloads are encoded and decoded again (round trip), the legacy format is
+  decoded and other protocol versions are ignored (see protocol.h)
+  Created by TheDIYGuy999
+*/
+
+#define PACKED_PROTOCOL
+#include "sketch.cpp"
+#include "test.h"
+
+int main() {
+  byte buf[maxFrameSize];
+  srand(1);
+
+  // Packed RcData frames: all fields survive the round trip
+  for (int n = 0; n < 10000; n++) {
+    int axes[4];
+    for (byte i = 0; i < 4; i++) axes[i] = axisFine[i] = rand() % 1001;
+    boolean mode1 = data.mode1 = rand() & 1;
+    boolean mode2 = data.mode2 = rand() & 1;
+    boolean momentary1 = data.momentary1 = rand() & 1;
+    byte pot1 = data.pot1 = rand() % 101;
+    byte mask = hopMask = rand() & 0x0F;
+    byte rate = txRateRequest = rand() % 3;
+    byte sequence = txSequence = n & 0x0F;
+
+    CHECK_EQUAL(encodeRcData(buf), packedFrameSize);
+    data = RcData();
+    memset(axisFine, 0, sizeof(axisFine));
+    CHECK(decodeRcData(buf, packedFrameSize));
+
+    CHECK(rxPacked);
+    CHECK_EQUAL(rxSequence, sequence);
+    for (byte i = 0; i < 4; i++) CHECK_EQUAL(axisFine[i], axes[i]);
+    CHECK_EQUAL(data.axis1, (axes[0] + 5) / 10);
+    CHECK_EQUAL(data.axis4, (axes[3] + 5) / 10);
+    CHECK_EQUAL(data.mode1, mode1);
+    CHECK_EQUAL(data.mode2, mode2);
+    CHECK_EQUAL(data.momentary1, momentary1);
+    CHECK_EQUAL(data.pot1, pot1);
+    CHECK_EQUAL(rxHopMask, mask);
+    CHECK_EQUAL(rxRateRequest, rate);
+  }
+
+  // Out of range values are limited
+  axisFine[0] = 1200;
+  axisFine[1] = -5;
+  data.pot1 = 150;
+  encodeRcData(buf);
+  decodeRcData(buf, packedFrameSize);
+  CHECK_EQUAL(axisFine[0], 1000);
+  CHECK_EQUAL(axisFine[1], 0);
+  CHECK_EQUAL(data.pot1, 100);
+
+  // Another protocol version: ignored, the data is not changed
+  axisFine[0] = 123;
+  encodeRcData(buf);
+  axisFine[0] = 456;
+  for (byte version = 0; version < 4; version++) {
+    if (version == protocolVersion) continue;
+    buf[0] = (buf[0] & 0xCF) | (version << 4);
+    CHECK(!decodeRcData(buf, packedFrameSize));
+    CHECK_EQUAL(axisFine[0], 456);
+  }
+
+  // Legacy RcData struct: the high resolution axes are derived from the 1% axes
+  RcData legacy;
+  legacy.axis1 = 0;
+  legacy.axis2 = 37;
+  legacy.axis3 = 100;
+  legacy.axis4 = 50;
+  legacy.mode1 = true;
+  legacy.pot1 = 42;
+  memcpy(buf, &legacy, sizeof(RcData));
+  CHECK(decodeRcData(buf, sizeof(RcData)));
+  CHECK(!rxPacked);
+  CHECK_EQUAL(axisFine[0], 0);
+  CHECK_EQUAL(axisFine[1], 370);
+  CHECK_EQUAL(axisFine[2], 1000);
+  CHECK_EQUAL(axisFine[3], 500);
+  CHECK(data.mode1);
+  CHECK_EQUAL(data.pot1, 42);
+
+  // Packed ACK payload: round trip with the sequence number echo
+  byte echo;
+  rxPacked = true;
+  for (int n = 0; n < 1000; n++) {
+    uint16_t vcc = payload.vcc = rand() & 0xFFFF;
+    uint16_t battery = payload.batteryVoltage = rand() & 0xFFFF;
+    byte channel = payload.channel = rand() % 126;
+    boolean ok = payload.batteryOk = rand() & 1;
+    byte confirm = ackRateConfirm = rand() % 3;
+    byte sequence = rxSequence = n & 0x0F;
+
+    CHECK_EQUAL(encodeAck(buf), packedAckSize);
+    payload = telemetryData();
+    ackRateConfirm = 0;
+    CHECK(decodeAck(buf, packedAckSize, echo));
+
+    CHECK_EQUAL(echo, sequence);
+    CHECK_EQUAL(payload.vcc, vcc);
+    CHECK_EQUAL(payload.batteryVoltage, battery);
+    CHECK_EQUAL(payload.channel, channel);
+    CHECK_EQUAL(payload.batteryOk, ok);
+    CHECK_EQUAL(ackRateConfirm, confirm);
+  }
+
+  // Another protocol version: ignored, the telemetry is not changed
+  payload.vcc = 3300;
+  encodeAck(buf);
+  payload.vcc = 3000;
+  buf[0] ^= 0x30;
+  CHECK(!decodeAck(buf, packedAckSize, echo));
+  CHECK_EQUAL(payload.vcc, 3000);
+
+  // Legacy ACK payload (float volts): mV are rounded, no echo
+  rxPacked = false;
+  payload.vcc = 3312;
+  payload.batteryVoltage = 7401;
+  payload.batteryOk = true;
+  payload.channel = 2;
+  byte len = encodeAck(buf);
+  CHECK_EQUAL(len, sizeof(ackPayload));
+  payload = telemetryData();
+  CHECK(decodeAck(buf, len, echo));
+  CHECK_EQUAL(echo, 0xFF);
+  CHECK_EQUAL(payload.vcc, 3312);
+  CHECK_EQUAL(payload.batteryVoltage, 7401);
+  CHECK(payload.batteryOk);
+  CHECK_EQUAL(payload.channel, 2);
+
+  return testResult("protocol");
+}
@@ -0,0 +1,120 @@
+/*
+  Frame recorder & replay (see recorder.h): a session is recorded via Serial and replayed with the original timing,
+  like "tools/recorder.py" does. The replayed frames are carrying the recorded inputs in the same order
+  Created by TheDIYGuy999
+*/
+
+#define RECORDER
+#include "sketch.cpp"
+#include "test.h"
+
+typedef std::vector<uint8_t> record;
+
+// Valid records in the Serial output ----
+std::vector<record> testRecords(const std::string &out, unsigned long &invalid) {
+  std::vector<record> records;
+  for (size_t i = 0; i + recorderLength <= out.size(); i += recorderLength) {
+    record r(out.begin() + i, out.begin() + i + recorderLength);
+    if (r[0] != recorderSync || recorderChecksum(r.data()) != r[recorderLength - 1]) invalid++;
+    else records.push_back(r);
+  }
+  return records;
+}
+
+// The inputs of the records (axes, pot & switches), without repetitions ----
+std::vector<record> testInputs(const std::vector<record> &records) {
+  std::vector<record> inputs;
+  for (size_t i = 0; i < records.size(); i++) {
+    record in(records[i].begin() + 3, records[i].begin() + 9);
+    in.push_back(records[i][9] & 0x07);
+    if (inputs.empty() || inputs.back() != in) inputs.push_back(in);
+  }
+  return inputs;
+}
+
+int main() {
+  hostRadioPeer = [](const hostFrame & frame) { // legacy receiver
+    ackPayload legacy;
+    legacy.vcc = 3.3;
+    legacy.batteryVoltage = 7.4;
+    legacy.batteryOk = true;
+    legacy.channel = frame.channel;
+    hostAck ack = {true, 0, sizeof(ackPayload), {0}};
+    memcpy(ack.data, &legacy, sizeof(ackPayload));
+    return ack;
+  };
+  setup();
+  testRun(500);
+
+  // Record a session with moving joysticks ----
+  hostSerialOut.clear();
+  size_t start = hostRadioSent.size();
+  for (int i = 0; i < 100; i++) {
+    testMove(i);
+    testRun(10);
+  }
+  testRun(100); // the last records are sent
+  unsigned long invalid = 0;
+  std::vector<record> original = testRecords(hostSerialOut, invalid);
+  CHECK_EQUAL(invalid, 0);
+  CHECK(original.size() >= 190); // the pots of the profile are moving: one frame per control task pass
+  CHECK(original.size() >= testFrames(start) - 1); // no dropped records (the last one may be open)
+
+  for (size_t i = 1; i < original.size(); i++) {
+    CHECK_EQUAL((uint8_t)(original[i][10] - original[i - 1][10]), 1); // frame counter without gaps
+    CHECK(original[i][9] & 0x08); // ACK received
+  }
+
+  // The recorded axes are the sent axes (the frame with the same time stamp) ----
+  size_t frame = start - 1; // the result of the previous frame was open
+  for (size_t i = 0; i < original.size(); i++) {
+    uint16_t time = original[i][1] | (original[i][2] << 8);
+    while (frame < hostRadioSent.size() && (uint16_t)(hostRadioSent[frame].time / 1000) != time) frame++;
+    if (frame == hostRadioSent.size()) break;
+    uint64_t axes = 0; // 4 x 10 bits
+    for (byte j = 0; j < 5; j++) axes |= (uint64_t)original[i][3 + j] << (8 * j);
+    for (byte ch = 0; ch < 4; ch++) {
+      int axis = (axes >> (10 * ch)) & 0x03FF;
+      if (hasPot(ch)) CHECK_EQUAL(hostRadioSent[frame].data[ch], (axis + 5) / 10);
+    }
+    frame++;
+  }
+  CHECK(frame < hostRadioSent.size()); // all records were found
+
+  // Replay with the original timing (joysticks at rest) ----
+  testRest();
+  testRun(1000);
+  hostSerialOut.clear();
+  uint64_t replayBegin = hostMicros;
+  unsigned long offset = 0;
+  for (size_t i = 0; i < original.size(); i++) {
+    if (i > 0) offset += (uint16_t)((original[i][1] | (original[i][2] << 8)) - (original[i - 1][1] | (original[i - 1][2] << 8)));
+    while (hostMicros < replayBegin + offset * 1000ULL) {
+      loop();
+      hostAdvance(10);
+    }
+    hostSerialIn.insert(hostSerialIn.end(), original[i].begin(), original[i].end());
+  }
+  testRun(1000); // the end of the replay
+  CHECK(!replayActive);
+
+  std::vector<record> replayed = testRecords(hostSerialOut, invalid);
+  CHECK_EQUAL(invalid, 0);
+  std::vector<record> inputs = testInputs(original);
+  std::vector<record> replayedInputs = testInputs(replayed);
+
+  // The replayed frames: the inputs at rest, the recorded inputs in the same order, the inputs at rest again
+  size_t first = 0;
+  while (first < replayedInputs.size() && replayedInputs[first] != inputs.front()) first++;
+  CHECK(first + inputs.size() <= replayedInputs.size());
+  size_t missing = 0;
+  for (size_t i = 0, j = first; i < inputs.size(); i++) {
+    size_t found = j;
+    while (found < replayedInputs.size() && replayedInputs[found] != inputs[i]) found++;
+    if (found == replayedInputs.size()) missing++;
+    else j = found + 1;
+  }
+  CHECK_EQUAL(missing, 0);
+
+  return testResult("recorder");
+}
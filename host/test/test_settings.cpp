@@ -0,0 +1,115 @@
+/*
+  Journaled settings store (see settings.h): power loss during a record write, queued saves of several vehicles,
+  unchanged saves. A reboot is simulated with an empty RAM state and settingsScan()
+  Created by TheDIYGuy999
+*/
+
+#include "sketch.cpp"
+#include "test.h"
+
+void setValues(byte reversed, byte travel) {
+  settings.reversed = reversed;
+  memset(settings.percentNegative, travel, 4);
+  memset(settings.percentPositive, travel, 4);
+}
+
+// The loaded settings of a vehicle are equal to the given values ----
+boolean hasValues(byte vehicle, byte reversed, byte travel) {
+  settingsLoad(vehicle);
+  if (settings.reversed != reversed) return false;
+  for (byte i = 0; i < 4; i++) {
+    if (settings.percentNegative[i] != travel || settings.percentPositive[i] != travel) return false;
+  }
+  return true;
+}
+
+// Settings task calls every 10ms, until all records are written (or the power is lost) ----
+void writeAll() {
+  for (int i = 0; i < 100; i++) settingsTask();
+}
+
+void reboot() {
+  hostEepromBudget = -1; // power on
+  settingsQueued = 0;
+  settingsWriteSlot = settingsNone;
+  settingsScan();
+}
+
+int main() {
+  reboot();
+  CHECK(hasValues(1, 0, 100)); // empty EEPROM: defaults
+
+  setValues(1, 80);
+  settingsSave(1);
+  writeAll();
+  reboot();
+  CHECK(hasValues(1, 1, 80));
+
+  // Unchanged settings are not written ----
+  unsigned long writes = hostEepromWrites;
+  settingsSave(1);
+  CHECK_EQUAL(settingsQueued, 0);
+  writeAll();
+  CHECK_EQUAL(hostEepromWrites, writes);
+
+  // Power loss after each byte of a record: the previous or the new record is valid, never a mix ----
+  byte reversed = 1, travel = 80;
+  unsigned long lost = 0;
+  for (long budget = 0; budget <= 20; budget++) {
+    byte newReversed = budget & 0x0F, newTravel = 21 + budget;
+    setValues(newReversed, newTravel);
+    settingsSave(1);
+    hostEepromBudget = budget;
+    writeAll();
+    reboot();
+
+    boolean previous = hasValues(1, reversed, travel);
+    boolean next = hasValues(1, newReversed, newTravel);
+    CHECK(previous || next);
+    if (budget >= settingsRecordSize) CHECK(next);
+    if (previous) lost++;
+    else {
+      reversed = newReversed;
+      travel = newTravel;
+    }
+  }
+  CHECK(lost >= 10); // a record changes 10 - 16 bytes
+
+  // Several vehicles within one record write time: all saves are queued ----
+  setValues(2, 50);
+  settingsSave(1);
+  setValues(4, 70);
+  settingsSave(2);
+  CHECK_EQUAL(settingsQueued, 2);
+  CHECK(hasValues(2, 4, 70)); // the queued record is loaded, before it is written
+  settingsTask();
+  settingsTask();
+  CHECK(hasValues(1, 2, 50)); // the record, which is written now
+  setValues(8, 90);
+  settingsSave(3); // the queue is not full, the record of vehicle 1 is being written
+  writes = hostEepromWrites;
+  setValues(3, 40);
+  settingsSave(4); // queue full: the newest record (vehicle 3) is replaced, no waiting
+  CHECK_EQUAL(settingsQueued, 2);
+  CHECK_EQUAL(hostEepromWrites, writes);
+  CHECK(hasValues(4, 3, 40));
+  writeAll();
+  reboot();
+  CHECK(hasValues(1, 2, 50));
+  CHECK(hasValues(2, 4, 70));
+  CHECK(hasValues(3, 0, 100)); // replaced: the defaults
+  CHECK(hasValues(4, 3, 40));
+
+  // A new save of the same vehicle replaces its queued record ----
+  setValues(5, 60);
+  settingsSave(2);
+  setValues(6, 65);
+  settingsSave(2);
+  CHECK_EQUAL(settingsQueued, 1);
+  writeAll();
+  reboot();
+  CHECK(hasValues(2, 6, 65));
+  CHECK(hasValues(1, 2, 50));
+
+  return testResult("settings");
+}
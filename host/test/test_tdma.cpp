@@ -0,0 +1,93 @@
+/*
+  Time sliced multi vehicle control (see tdma.h): one receiver per pipe. The frames are sent to the vehicles in a
+  row, the ACK payload is kept per vehicle and the link is lost, if one vehicle doesn't answer
+  Created by TheDIYGuy999
+*/
+
+#include "sketch.cpp"
+#include "test.h"
+
+boolean vehicleOn[4] = {false, true, true, false}; // vehicle 1 - 3, vehicle 3 is switched off
+unsigned long peerFrames[4];
+
+// Legacy receiver of vehicle 1 - 3, the battery voltage is 7.1V + vehicle number x 0.1V ----
+hostAck vehiclePeer(const hostFrame &frame) {
+  hostAck ack = {false, 0, 0, {0}};
+  for (byte vehicle = 1; vehicle <= 3; vehicle++) {
+    if (frame.pipe != pgm_read_64(&pipeOut, vehicle - 1)) continue;
+    peerFrames[vehicle]++;
+    if (!vehicleOn[vehicle]) return ack;
+    ackPayload legacy;
+    legacy.vcc = 3.3;
+    legacy.batteryVoltage = 7.1 + vehicle * 0.1;
+    legacy.batteryOk = true;
+    legacy.channel = frame.channel;
+    ack.ok = true;
+    ack.size = sizeof(ackPayload);
+    memcpy(ack.data, &legacy, sizeof(ackPayload));
+  }
+  return ack;
+}
+
+int main() {
+  hostRadioPeer = vehiclePeer;
+  setup();
+  testRun(1000);
+  CHECK(transmissionState);
+  CHECK_EQUAL(payload.batteryVoltage, 7200);
+
+  // The settings of vehicle 2 are queued, but not written yet ----
+  vehicleSettings active = settings;
+  settings.reversed = 0x05;
+  memset(settings.percentNegative, 50, 4);
+  memset(settings.percentPositive, 60, 4);
+  settingsSave(2);
+  settings = active;
+
+  tdmaToggle(0);
+  tdmaToggle(1);
+  tdmaToggle(2);
+  startTdma();
+  CHECK(tdmaActive);
+  CHECK_EQUAL(tdmaCount, 3);
+  CHECK_EQUAL(tdmaSettings[1].reversed, 0x05);
+  CHECK_EQUAL(tdmaSettings[1].percentNegative[0], 50);
+  CHECK_EQUAL(tdmaSettings[1].percentPositive[3], 60);
+  CHECK_EQUAL(tdmaSettings[0].reversed, active.reversed);
+
+  // Vehicle 3 doesn't answer: the link is lost, the ACKs of vehicle 1 & 2 are kept separately ----
+  size_t start = hostRadioSent.size();
+  for (int i = 0; i < 300; i++) {
+    testMove(i);
+    testRun(10);
+  }
+  CHECK(!transmissionState);
+  CHECK(tdmaStats[0].rate >= 60 && tdmaStats[0].rate <= 67); // 200Hz / 3
+  CHECK(tdmaStats[1].rate >= 60 && tdmaStats[1].rate <= 67);
+  CHECK_EQUAL(tdmaStats[2].rate, 0);
+  CHECK_EQUAL(tdmaStats[0].payload.batteryVoltage, 7200);
+  CHECK_EQUAL(tdmaStats[1].payload.batteryVoltage, 7300);
+  CHECK(peerFrames[3] > 150); // still in the row
+
+  // The frames are sent to the vehicles in a row ----
+  for (size_t i = start + 3; i < hostRadioSent.size(); i++) {
+    CHECK(hostRadioSent[i].pipe == hostRadioSent[i - 3].pipe);
+    if (hostRadioSent[i].pipe != hostRadioSent[i - 3].pipe) break;
+  }
+
+  // Vehicle 3 is switched on: the link is up again ----
+  vehicleOn[3] = true;
+  for (int i = 0; i < 200; i++) {
+    testMove(i);
+    testRun(10);
+  }
+  CHECK(transmissionState);
+  CHECK_EQUAL(tdmaStats[2].payload.batteryVoltage, 7400);
+  CHECK(tdmaStats[2].rate >= 60);
+
+  // Back to vehicle 1 ----
+  selectVehicle(1);
+  CHECK(!tdmaActive);
+
+  return testResult("tdma");
+}
@@ -0,0 +1,141 @@
+/*
+  Link adaptive data rate and power amplifier (PA) control for the "Micro RC" transmitter
+
+  The ACK success and the auto retransmits are evaluated every 32 frames. A good link steps up one level (higher
+  data rate = lower latency, then lower PA level = longer battery life), a bad link steps down one level.
+  8 lost frames in a row: immediate fallback to 250kbps and max. PA.
+
+  Data rate changes are negotiated with the receiver (packed protocol only, legacy receivers are fixed to 250kbps):
+  1. the transmitter requests the new rate in every frame
+  2. the receiver confirms it in the ACK payload of the next frame and switches after that frame
+  3. the transmitter switches, as soon as it receives the confirmation
+  If one side switches alone, the link is lost and both sides fall back to 250kbps.
+  Created by TheDIYGuy999
+*/
+
+#ifndef linkControl_h
+#define linkControl_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// LINK CONTROL SETTINGS & VARIABLES
+// =======================================================================================================
+//
+
+// Data rate codes (used in the packed protocol)
+const byte RATE_250K = 0;
+const byte RATE_1M = 1;
+const byte RATE_2M = 2;
+const rf24_datarate_e rateSettings[] = {RF24_250KBPS, RF24_1MBPS, RF24_2MBPS};
+
+// Link levels, from the most robust to the most economic one
+struct linkLevel {
+  byte rate; // data rate code
+  byte pa; // power amplifier level (limited by the board version)
+};
+#ifdef PACKED_PROTOCOL
+const linkLevel linkLevels[] = {
+  {RATE_250K, RF24_PA_MAX}, {RATE_1M, RF24_PA_MAX}, {RATE_2M, RF24_PA_MAX}, {RATE_2M, RF24_PA_HIGH}, {RATE_2M, RF24_PA_LOW}
+};
+#else // PA level only
+const linkLevel linkLevels[] = {
+  {RATE_250K, RF24_PA_MAX}, {RATE_250K, RF24_PA_HIGH}, {RATE_250K, RF24_PA_LOW}
+};
+#endif
+const byte linkLevelCount = sizeof(linkLevels) / sizeof(linkLevel);
+
+const byte rateWindow = 32; // frames per evaluation
+const byte rateUpRetries = 4; // step up: no lost frame and max. 4 retries per window
+const byte rateDownLost = 3; // step down: min. 3 lost frames
+const byte rateDownRetries = 48; // or min. 48 retries per window (1.5 per frame)
+const unsigned long rateHoldTime = 2000; // ms, min. time between a change and the next step up (hysteresis)
+const byte rateFallbackLost = 8; // lost frames in a row for the immediate fallback
+
+byte linkLevelNow = 0; // the active link level
+byte radioRate = RATE_250K; // the active data rate (both modes)
+byte paLimit = RF24_PA_MAX; // max. PA level of this board
+byte rateFrames, rateLost, rateRetries, rateLostInRow; // evaluation window
+unsigned long rateChanged; // millis() of the last level change
+
+//
+// =======================================================================================================
+// SWITCH THE DATA RATE & LEVEL
+// =======================================================================================================
+//
+
+void setRadioRate(byte rate) {
+  radioRate = rate;
+  radio.setDataRate(rateSettings[rate]);
+}
+
+// PA is switched immediately, the data rate is requested from the receiver ----
+void setLinkLevel(byte level) {
+  linkLevelNow = level;
+  radio.setPALevel(min(linkLevels[level].pa, paLimit));
+  txRateRequest = linkLevels[level].rate;
+  rateChanged = millis();
+  rateFrames = rateLost = rateRetries = 0;
+}
+
+// Most robust level, called by setupRadio() ----
+void resetLinkControl() {
+  setRadioRate(RATE_250K);
+  setLinkLevel(0);
+  ackRateConfirm = RATE_250K;
+  rateLostInRow = 0;
+}
+
+//
+// =======================================================================================================
+// TRANSMITTER: EVALUATE THE RESULT OF A FRAME (called by pollRadio(), after the ACK payload was read)
+// =======================================================================================================
+//
+
+void rateResult(boolean ok, byte retries) {
+
+  // The receiver has confirmed the requested data rate, so we switch too
+  if (ok && ackRateConfirm == txRateRequest && radioRate != txRateRequest) setRadioRate(txRateRequest);
+
+  // Fast fallback ----
+  if (ok) rateLostInRow = 0;
+  else if (rateLostInRow < 255) rateLostInRow ++;
+
+  if (rateLostInRow >= rateFallbackLost) {
+    if (linkLevelNow > 0 || radioRate != RATE_250K) {
+      setRadioRate(RATE_250K); // no negotiation, the receiver falls back as well, if it doesn't hear us
+      setLinkLevel(0);
+    }
+    return;
+  }
+
+  // Evaluation window ----
+  rateFrames ++;
+  if (ok) rateRetries = min(rateRetries + retries, 255);
+  else rateLost ++;
+  if (rateFrames < rateWindow) return;
+
+  if ((rateLost >= rateDownLost || rateRetries >= rateDownRetries) && linkLevelNow > 0) {
+    setLinkLevel(linkLevelNow - 1); // step down
+  }
+  else if (rateLost == 0 && rateRetries <= rateUpRetries && linkLevelNow < linkLevelCount - 1
+           && radioRate == txRateRequest && millis() - rateChanged > rateHoldTime) {
+    setLinkLevel(linkLevelNow + 1); // step up (only, if the previous change is completed)
+  }
+  rateFrames = rateLost = rateRetries = 0;
+}
+
+//
+// =======================================================================================================
+// RECEIVER (radio tester mode): FOLLOW THE DATA RATE REQUEST
+// =======================================================================================================
+//
+
+// After a packed frame: switch, if the request was already confirmed in the ACK of this frame ----
+void rateFollow() {
+  if (rxRateRequest != radioRate && rxRateRequest == ackRateConfirm) setRadioRate(rxRateRequest);
+  ackRateConfirm = rxRateRequest; // confirmation for the ACK payload of the next frame
+}
+
+#endif
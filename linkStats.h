@@ -0,0 +1,133 @@
+/*
+  Radio link statistics for the "Micro RC" transmitter
+  The result of every frame (ACK, auto retransmits, round trip time) is stored in a ring buffer. Packets per second,
+  loss, average retries and round trip time percentiles are calculated every second over the last 64 frames.
+  Shown on the link diagnostics screen and printed via Serial with the "LINK_STATS" build option.
+  Created by TheDIYGuy999
+*/
+
+#ifndef linkStats_h
+#define linkStats_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// LINK STATISTICS VARIABLES
+// =======================================================================================================
+//
+
+const byte linkWindow = 64; // frames in the ring buffer (power of 2!)
+const byte linkRttUnit = 32; // round trip time resolution in us (max. 255 units = 8.1ms)
+
+const byte LINK_ACK = 0x80; // ring buffer flags: ACK received
+const byte LINK_RETRIES = 0x0F; // auto retransmits
+
+struct linkFrame {
+  byte flags; // ACK & number of retries
+  byte rtt; // round trip time in linkRttUnit
+};
+linkFrame linkBuffer[linkWindow];
+byte linkHead = 0; // next entry
+byte linkCount = 0; // valid entries
+
+unsigned int linkSent = 0; // frames during the current second
+unsigned int linkAcked = 0; // acknowledged frames during the current second
+boolean linkPreviousAck = false; // the previous frame was acknowledged
+
+struct linkSummary {
+  unsigned int sentPerSecond; // sent frames per second
+  unsigned int ackedPerSecond; // acknowledged frames per second
+  byte loss; // frames without ACK in % (window)
+  byte retries; // average auto retransmits * 10 (window)
+  unsigned int rtt50, rtt90, rttMax; // round trip time percentiles in us (window, acknowledged frames only)
+  unsigned int ackLost; // frames, which were received, but the ACK was lost (packed protocol only, since power on)
+};
+linkSummary linkStats;
+
+//
+// =======================================================================================================
+// STORE THE RESULT OF A FRAME
+// =======================================================================================================
+//
+
+// "sequence" = sequence number of the frame, "echo" = sequence number echo from the ACK payload (0xFF = none) ----
+void linkRecord(boolean ack, byte retries, unsigned long rttMicros, byte sequence, byte echo) {
+
+  linkBuffer[linkHead].flags = (ack ? LINK_ACK : 0) | min(retries, LINK_RETRIES);
+  linkBuffer[linkHead].rtt = min(rttMicros / linkRttUnit, 255UL);
+  linkHead = (linkHead + 1) & (linkWindow - 1);
+  if (linkCount < linkWindow) linkCount ++;
+
+  linkSent ++;
+  if (ack) linkAcked ++;
+
+  // The receiver echoes the last frame it got before this one. No ACK for the previous frame, but received = ACK lost
+  if (echo != 0xFF && echo == ((sequence - 1) & 0x0F) && !linkPreviousAck) linkStats.ackLost ++;
+  linkPreviousAck = ack;
+}
+
+//
+// =======================================================================================================
+// CALCULATE THE SUMMARY (every second)
+// =======================================================================================================
+//
+
+void linkUpdate() {
+
+  static unsigned long lastUpdate;
+  if (millis() - lastUpdate < 1000) return;
+  lastUpdate = millis();
+
+  linkStats.sentPerSecond = linkSent;
+  linkStats.ackedPerSecond = linkAcked;
+  linkSent = 0;
+  linkAcked = 0;
+
+  // Loss, retries and a sorted copy of the round trip times ----
+  byte rtt[linkWindow];
+  byte acks = 0;
+  unsigned int retries = 0;
+
+  for (byte i = 0; i < linkCount; i++) {
+    if (!(linkBuffer[i].flags & LINK_ACK)) continue;
+    retries += linkBuffer[i].flags & LINK_RETRIES;
+
+    byte j = acks++; // insertion sort (max. 64 entries, once per second)
+    while (j > 0 && rtt[j - 1] > linkBuffer[i].rtt) {
+      rtt[j] = rtt[j - 1];
+      j--;
+    }
+    rtt[j] = linkBuffer[i].rtt;
+  }
+
+  if (linkCount > 0) linkStats.loss = (linkCount - acks) * 100 / linkCount;
+  if (acks > 0) {
+    linkStats.retries = retries * 10 / acks;
+    linkStats.rtt50 = rtt[acks / 2] * linkRttUnit;
+    linkStats.rtt90 = rtt[acks * 9 / 10] * linkRttUnit;
+    linkStats.rttMax = rtt[acks - 1] * linkRttUnit;
+  }
+  else linkStats.retries = linkStats.rtt50 = linkStats.rtt90 = linkStats.rttMax = 0;
+
+#ifdef LINK_STATS
+  Serial.print(F("Link: sent/s, acked/s, loss %, retries x10, RTT 50%, 90%, max us, ACK lost\t"));
+  Serial.print(linkStats.sentPerSecond);
+  Serial.print(F("\t"));
+  Serial.print(linkStats.ackedPerSecond);
+  Serial.print(F("\t"));
+  Serial.print(linkStats.loss);
+  Serial.print(F("\t"));
+  Serial.print(linkStats.retries);
+  Serial.print(F("\t"));
+  Serial.print(linkStats.rtt50);
+  Serial.print(F("\t"));
+  Serial.print(linkStats.rtt90);
+  Serial.print(F("\t"));
+  Serial.print(linkStats.rttMax);
+  Serial.print(F("\t"));
+  Serial.println(linkStats.ackLost);
+#endif
+}
+
+#endif
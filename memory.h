@@ -0,0 +1,70 @@
+/*
+  SRAM usage report for the "Micro RC" transmitter (AVR only)
+  The free RAM between the static variables and the stack is painted with a pattern during the startup ("stack
+  painting"). The untouched part of the pattern shows, how deep the stack has ever been.
+  Created by TheDIYGuy999
+*/
+
+#ifndef memory_h
+#define memory_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// MEMORY VARIABLES
+// =======================================================================================================
+//
+
+extern uint8_t __data_start; // start of the static variables (linker symbols)
+extern uint8_t _end; // end of the static variables
+extern uint8_t __stack; // top of the stack (RAMEND)
+
+const uint8_t stackPaint = 0xC5;
+
+struct memoryUsage {
+  unsigned int staticRam; // .data & .bss in bytes
+  unsigned int stackMax; // worst case stack depth since power on in bytes
+  unsigned int headroom; // never used RAM in bytes
+};
+memoryUsage memory;
+
+//
+// =======================================================================================================
+// PAINT THE STACK (executed during the startup, before the static variables are initialized)
+// =======================================================================================================
+//
+
+void paintStack() __attribute__ ((naked, used, section (".init3")));
+void paintStack() {
+  uint8_t *p = &_end;
+  while (p <= &__stack) *p++ = stackPaint; // the stack is still empty
+}
+
+//
+// =======================================================================================================
+// MEASURE THE MEMORY USAGE
+// =======================================================================================================
+//
+
+void measureMemory() {
+  const uint8_t *p = &_end;
+  while (p <= &__stack && *p == stackPaint) p++; // the first byte, which was overwritten by the stack
+
+  memory.staticRam = &_end - &__data_start;
+  memory.stackMax = &__stack - p + 1;
+  memory.headroom = p - &_end;
+}
+
+// Print the report via Serial (during setup) ----
+void printMemoryReport() {
+  measureMemory();
+  Serial.print(F("RAM: static "));
+  Serial.print(memory.staticRam);
+  Serial.print(F(", stack max. "));
+  Serial.print(memory.stackMax);
+  Serial.print(F(", never used "));
+  Serial.println(memory.headroom);
+}
+
+#endif
@@ -2,6 +2,11 @@
   A simple "1972 Atari Pong" game. Handy, if you crashed your RC car ;-)
   This code is based on: https://github.com/eholk/Arduino-Pong/blob/master/pong.ino
   Modified to use it with the u8glib and my "Micro RC" transmitter by TheDIYGuy999
+  The physics are calculated with fixed point coordinates (1/64 pixel) and a fixed timestep of 5ms. The elapsed time
+  is collected in an accumulator, so the ball speed doesn't depend on the display throughput. The paddle collisions
+  are tested along the path of the ball (no pixel is skipped). The ball is getting faster with every hit, the angle
+  depends on the hit position on the paddle. The result of a step only depends on the player paddle input, so a game
+  can be replayed with the same inputs. The display task renders a snapshot of the game, one page per call.
 */
 
 #ifndef pong_h
@@ -9,27 +14,30 @@
 
 #include "Arduino.h"
 
-const uint8_t PADDLE_RATE = 15; // 15
-const uint8_t BALL_RATE = 7; // 7
-const uint8_t FRAME_RATE = 70; // Refresh display every 70ms = 14.2Hz (less slows the ball update down on an 8MHz MPU...)
+const uint8_t PONG_STEP = 5; // ms, fixed physics timestep
+const uint8_t PONG_MAX_STEPS = 8; // max. steps to catch up (the game is slowed down, if it's blocked for more than 40ms)
+const int PONG_FIX = 64; // sub pixels per pixel
+
+const uint8_t PADDLE_RATE = 15; // ms per pixel, CPU paddle
+const uint8_t BALL_RATE = 7; // ms per pixel, start speed of the ball
+const uint8_t FRAME_RATE = 40; // min. ms between two display frames (the display throughput is the limit)
 const uint8_t PADDLE_HEIGHT = 14; // 14
 
 const uint8_t half_paddle = PADDLE_HEIGHT / 2;
 
-uint8_t ball_x = 64, ball_y = 32; // 64, 32
-uint8_t ball_dir_x = -1, ball_dir_y = 1; // 1, 1
-
-uint8_t new_x;
-uint8_t new_y;
-
-unsigned long ball_update;
-unsigned long paddle_update;
+const int BALL_SPEED = PONG_FIX * PONG_STEP / BALL_RATE; // sub pixels per step, horizontal
+const int BALL_SPEED_MAX = BALL_SPEED * 2;
+const int PADDLE_SPEED = PONG_FIX * PONG_STEP / PADDLE_RATE; // sub pixels per step
 
 const uint8_t CPU_X = 12; // 12
-uint8_t cpu_y = 16;
-
 const uint8_t PLAYER_X = 115; // 115
-uint8_t player_y = 16;
+
+// Game state (fixed point coordinates) ----
+int ball_x = 64 * PONG_FIX, ball_y = 32 * PONG_FIX; // 64, 32
+int ball_speed_x = -BALL_SPEED, ball_speed_y = BALL_SPEED; // 45°
+int cpu_y = 16 * PONG_FIX;
+int player_y = 16 * PONG_FIX;
+boolean center = false;
 
 uint8_t game_over_difference = 10; // The game is over after this point difference is reached!
 
@@ -39,80 +47,159 @@ uint8_t player_points = 0;
 boolean cpu_won = false;
 boolean player_won = false;
 
+// Snapshot for the display (pixel coordinates) ----
+struct pongView {
+  uint8_t ball_x, ball_y;
+  uint8_t cpu_y, player_y;
+  uint8_t cpu_points, player_points;
+  boolean cpu_won, player_won;
+};
+pongView pong_view;
+
+//
+// =======================================================================================================
+// PHYSICS STEP (one fixed timestep, player_input = joystick axis 0 - 100)
+// =======================================================================================================
+//
+
+// Paddle hit: reflect at the paddle face, faster & new angle from the hit position ----
+void paddleHit(int face, int paddle_y) {
+  ball_x = 2 * face - ball_x;
+  int speed = min(abs(ball_speed_x) + abs(ball_speed_x) / 16, BALL_SPEED_MAX);
+  ball_speed_x = (ball_speed_x < 0) ? speed : -speed;
+  int offset = ball_y - paddle_y - half_paddle * PONG_FIX; // -7 to +7 pixels from the center
+  ball_speed_y = (long)offset * speed / (half_paddle * PONG_FIX); // max. 45° at the paddle ends
+}
+
+// Swept collision test: did the ball cross the face between the two positions within the paddle height? ----
+boolean paddleCrossed(int face, int prev_x, int prev_y, int paddle_y) {
+  if ((prev_x - face) * (long)(ball_x - face) > 0 || prev_x == face) return false; // not crossed
+  int y = prev_y + (long)ball_speed_y * (face - prev_x) / ball_speed_x; // height at the crossing point
+  return y >= paddle_y && y <= paddle_y + PADDLE_HEIGHT * PONG_FIX;
+}
+
+void pongStep(uint8_t player_input) {
+  if (cpu_won || player_won) return;
+
+  // Ball ----
+  int prev_x = ball_x;
+  int prev_y = ball_y;
+  ball_x += ball_speed_x;
+  ball_y += ball_speed_y;
+
+  // Check if we hit the paddles (only from the field side)
+  if (ball_speed_x < 0 && paddleCrossed(CPU_X * PONG_FIX, prev_x, prev_y, cpu_y)) paddleHit(CPU_X * PONG_FIX, cpu_y);
+  if (ball_speed_x > 0 && paddleCrossed(PLAYER_X * PONG_FIX, prev_x, prev_y, player_y)) paddleHit(PLAYER_X * PONG_FIX, player_y);
+
+  // Check if we hit the horizontal walls
+  if (ball_y < 1 * PONG_FIX) {
+    ball_y = 2 * 1 * PONG_FIX - ball_y;
+    ball_speed_y = -ball_speed_y;
+  }
+  if (ball_y > 62 * PONG_FIX) {
+    ball_y = 2 * 62 * PONG_FIX - ball_y;
+    ball_speed_y = -ball_speed_y;
+  }
+
+  // Check if we hit the vertical walls
+  if (ball_x < 1 * PONG_FIX) {
+    ball_x = 2 * 1 * PONG_FIX - ball_x;
+    ball_speed_x = -ball_speed_x;
+  }
+  if (ball_x > 126 * PONG_FIX) {
+    ball_x = 2 * 126 * PONG_FIX - ball_x;
+    ball_speed_x = -ball_speed_x;
+  }
+
+  // Counter (a missed ball is slowed down to the start speed)
+  if (ball_x > 54 * PONG_FIX && ball_x < 74 * PONG_FIX) center = true;
+  if (center && (ball_x < CPU_X * PONG_FIX || ball_x > PLAYER_X * PONG_FIX)) {
+    if (ball_x < CPU_X * PONG_FIX) player_points++; // Count Player points
+    else cpu_points++; // Count CPU points
+    center = false;
+    ball_speed_x = (ball_speed_x < 0) ? -BALL_SPEED : BALL_SPEED;
+    ball_speed_y = (ball_speed_y < 0) ? -BALL_SPEED : BALL_SPEED;
+  }
+
+  if (cpu_points - player_points >= game_over_difference) cpu_won = true; // Game over, you lost
+  if (player_points - cpu_points >= game_over_difference) player_won = true; // Game over, you won
+
+  // CPU paddle control ----
+  if (cpu_y + half_paddle * PONG_FIX > ball_y) cpu_y -= PADDLE_SPEED;
+  if (cpu_y + half_paddle * PONG_FIX < ball_y) cpu_y += PADDLE_SPEED;
+  cpu_y = constrain(cpu_y, 1 * PONG_FIX, (63 - PADDLE_HEIGHT) * PONG_FIX);
+
+  // Player paddle control ----
+  player_y = map(player_input, 100, 0, 0, (63 - PADDLE_HEIGHT)) * PONG_FIX;
+}
+
 //
 // =======================================================================================================
-// DISPLAY UPDATE SUBFUNCTION
+// DISPLAY (the snapshot is taken, when a new frame can be started)
 // =======================================================================================================
 //
 
-void displayUpdate() {
-
-  static unsigned long lastDisplay;
-  if (millis() - lastDisplay >= FRAME_RATE) {
-    lastDisplay = millis();
-
-    // clear screen ----
-    u8g.firstPage();
-    do {
-      //u8g.drawFrame(0, 0, 128, 64); // only for screen offset test!
-      u8g.drawCircle(new_x, new_y, 1); // Ball
-      u8g.drawVLine(CPU_X, cpu_y, PADDLE_HEIGHT); // CPU paddle
-      u8g.drawVLine(PLAYER_X, player_y, PADDLE_HEIGHT); // Player paddle
-
-      u8g.drawVLine(64, 0, 3); // Vertical dashed line segments
-      u8g.drawVLine(64, 6, 3);
-      u8g.drawVLine(64, 12, 3);
-      u8g.drawVLine(64, 18, 3);
-      u8g.drawVLine(64, 24, 3);
-      u8g.drawVLine(64, 30, 3);
-      u8g.drawVLine(64, 36, 3);
-      u8g.drawVLine(64, 42, 3);
-      u8g.drawVLine(64, 48, 3);
-      u8g.drawVLine(64, 54, 3);
-      u8g.drawVLine(64, 60, 3);
-
-      u8g.setPrintPos(40, 10);  // CPU points counter
-      u8g.print(cpu_points);
-
-      u8g.setPrintPos(80, 10); // Player points counter
-      u8g.print(player_points);
-
-      // Game over window
-      if (cpu_won || player_won) {
-        u8g.setColorIndex(0);
-        u8g.drawBox(22, 12, 84, 45); // Clear area behind window
-        u8g.setColorIndex(1);
-        u8g.drawFrame(22, 12, 84, 45); // Draw window frame
-
-        u8g.setPrintPos(36, 28);
-        u8g.print("GAME OVER"); // Game over
-        u8g.setPrintPos(31, 48);
-        u8g.print("Press BACK!"); // Press button "Back" to restart
-      }
-      if (cpu_won ) {
-        u8g.setPrintPos(38, 38);
-        u8g.print("YOU LOST"); // You lost
-      }
-      if (player_won ) {
-        u8g.setPrintPos(40, 38);
-        u8g.print("YOU WON"); // You won
-      }
-
-      // show display queue ----
-    } while ( u8g.nextPage() );
+// Returns true, if a new frame has to be requested ----
+boolean pongFrameDue() {
+  static unsigned long lastFrame;
+  if (displayBusy || displayRequested || millis() - lastFrame < FRAME_RATE) return false;
+  lastFrame = millis();
+
+  pong_view.ball_x = ball_x / PONG_FIX;
+  pong_view.ball_y = ball_y / PONG_FIX;
+  pong_view.cpu_y = cpu_y / PONG_FIX;
+  pong_view.player_y = player_y / PONG_FIX;
+  pong_view.cpu_points = cpu_points;
+  pong_view.player_points = player_points;
+  pong_view.cpu_won = cpu_won;
+  pong_view.player_won = player_won;
+  return true;
+}
+
+// Draws the snapshot into the current page ----
+void pongDraw() {
+  //u8g.drawFrame(0, 0, 128, 64); // only for screen offset test!
+  u8g.drawCircle(pong_view.ball_x, pong_view.ball_y, 1); // Ball
+  u8g.drawVLine(CPU_X, pong_view.cpu_y, PADDLE_HEIGHT); // CPU paddle
+  u8g.drawVLine(PLAYER_X, pong_view.player_y, PADDLE_HEIGHT); // Player paddle
+
+  for (uint8_t y = 0; y < 64; y += 6) u8g.drawVLine(64, y, 3); // Vertical dashed line segments
+
+  u8g.setPrintPos(40, 10);  // CPU points counter
+  u8g.print(pong_view.cpu_points);
+
+  u8g.setPrintPos(80, 10); // Player points counter
+  u8g.print(pong_view.player_points);
+
+  // Game over window
+  if (pong_view.cpu_won || pong_view.player_won) {
+    u8g.setColorIndex(0);
+    u8g.drawBox(22, 12, 84, 45); // Clear area behind window
+    u8g.setColorIndex(1);
+    u8g.drawFrame(22, 12, 84, 45); // Draw window frame
+
+    u8g.setPrintPos(36, 28);
+    u8g.print(F("GAME OVER")); // Game over
+    u8g.setPrintPos(31, 48);
+    u8g.print(F("Press BACK!")); // Press button "Back" to restart
+  }
+  if (pong_view.cpu_won) {
+    u8g.setPrintPos(38, 38);
+    u8g.print(F("YOU LOST")); // You lost
+  }
+  if (pong_view.player_won) {
+    u8g.setPrintPos(40, 38);
+    u8g.print(F("YOU WON")); // You won
   }
 }
 
 //
 // =======================================================================================================
-// PONG GAME
+// PONG GAME (background task)
 // =======================================================================================================
 //
 
 void pong() {
-  unsigned long time = millis();
-
-  static boolean center;
 
   // Restart game ----------------------------------------------------------
   if (digitalRead(BUTTON_BACK) == LOW) {
@@ -122,81 +209,19 @@ void pong() {
     player_points = 0;
   }
 
-  // Ball update -----------------------------------------------------------
-  static unsigned long lastBall;
-  if (millis() - lastBall >= BALL_RATE && !cpu_won && !player_won) {
-    lastBall = millis();
-
-    new_x = ball_x + ball_dir_x;
-    new_y = ball_y + ball_dir_y;
-
-    // Counter
-    if (new_x > 54 && new_x < 74) center = true;
-    if (center && new_x < CPU_X) player_points++, center = false; // Count CPU points
-    if (center && new_x > PLAYER_X) cpu_points++, center = false; // Count Player points
-
-    if (cpu_points - player_points >= game_over_difference) cpu_won = true; // Game over, you lost
-    if (player_points - cpu_points >= game_over_difference) player_won = true; // Game over, you won
-
-    // Check if we hit the vertical walls
-    if (new_x == 1 || new_x == 126) {
-      ball_dir_x = -ball_dir_x;
-      new_x += ball_dir_x + ball_dir_x;
-    }
-
-    // Check if we hit the horizontal walls
-    if (new_y == 1 || new_y == 62) {
-      ball_dir_y = -ball_dir_y;
-      new_y += ball_dir_y + ball_dir_y;
-    }
-
-    // Check if we hit the CPU paddle
-    if (new_x == CPU_X
-        && new_y >= cpu_y
-        && new_y <= cpu_y + PADDLE_HEIGHT)
-    {
-      ball_dir_x = -ball_dir_x;
-      new_x += ball_dir_x + ball_dir_x;
-    }
-
-    // Check if we hit the player paddle
-    if (new_x == PLAYER_X
-        && new_y >= player_y
-        && new_y <= player_y + PADDLE_HEIGHT)
-    {
-      ball_dir_x = -ball_dir_x;
-      new_x += ball_dir_x + ball_dir_x;
-    }
-
-    ball_x = new_x;
-    ball_y = new_y;
+  // Physics: fixed timesteps for the elapsed time ---------------------------
+  static unsigned long lastStep;
+  static unsigned long accumulator;
+  unsigned long now = micros();
+  accumulator += now - lastStep;
+  lastStep = now;
+  if (accumulator > PONG_MAX_STEPS * PONG_STEP * 1000UL) accumulator = PONG_MAX_STEPS * PONG_STEP * 1000UL;
+
+  while (accumulator >= PONG_STEP * 1000UL) {
+    accumulator -= PONG_STEP * 1000UL;
+    if (hasPot(1)) pongStep(data.axis2); // If we have an elevator joystick (= 4 channel joystick transmitter)
+    else pongStep(data.axis1); // Else (car style transmitter)
   }
-
-  // Paddle update -----------------------------------------------------------
-  static unsigned long lastPaddle;
-  if (millis() - lastPaddle >= PADDLE_RATE && !cpu_won && !player_won) {
-    lastPaddle = millis();
-
-    // CPU paddle control----
-    if (cpu_y + half_paddle > ball_y) {
-      cpu_y -= 1;
-    }
-    if (cpu_y + half_paddle < ball_y) {
-      cpu_y += 1;
-    }
-    if (cpu_y < 1) cpu_y = 1;
-    if (cpu_y + PADDLE_HEIGHT > 63) cpu_y = 63 - PADDLE_HEIGHT;
-
-    // Player paddle control----
-#ifdef CONFIG_MICRO_RC // If we have a channel 4 (= 4 channel joystick transmitter)
-    player_y = map(data.axis2, 100, 0, 0, (63 - PADDLE_HEIGHT));
-#else // Else (2 channel car style transmitter)
-    player_y = map(data.axis1, 100, 0, 0, (63 - PADDLE_HEIGHT));
-#endif
-  }
-
-  // Display update ------------------------------------------------------------
-  displayUpdate();
 }
 
 #endif
@@ -0,0 +1,162 @@
+/*
+  Adaptive frame rate & idle sleep for the "Micro RC" transmitter
+  Frames are sent with the full rate (every control task pass), as long as the inputs are changing. After 1s without
+  a change, only keep-alive frames are sent. The receiver starts to search the signal after 50ms without a frame and
+  a receiver, which missed a frame, waits for the whole hop sequence on its channel: so the keep-alive period times
+  the hop sequence length has to be shorter than 50ms (packed protocol: 4 slots, every 10ms. Legacy: 2 channels,
+  every 20ms, in control task steps). The failsafe is triggered after 1s. A change is sent in the next control task pass.
+  The CPU sleeps (idle mode) while no task is due and no frame is in the air. It's woken up by the next interrupt
+  (ADC scan every 0.2ms, millis() timer every 1ms, buttons). The radio is in standby between the frames.
+  The sleep ratio, the frame rate and the input to air latency are shown on the power diagnostics screen. The latency
+  is measured from the ADC scan, which delivered the changed input, until the frame with the change is acknowledged.
+  Created by TheDIYGuy999
+*/
+
+#ifndef power_h
+#define power_h
+
+#include "Arduino.h"
+#include <avr/sleep.h>
+
+//
+// =======================================================================================================
+// POWER SETTINGS & VARIABLES
+// =======================================================================================================
+//
+
+const unsigned long powerIdleDelay = 1000; // ms without an input change, before the keep-alive rate is used
+const unsigned long powerControlPeriod = 5; // ms, the frames are sent by the control task (200Hz, see setupTasks())
+const unsigned long powerKeepAlive = (hopSearchTimeout - 1) / hopSequenceLength - powerControlPeriod; // ms, keep-alive frame period
+static_assert((powerKeepAlive + powerControlPeriod) * hopSequenceLength < hopSearchTimeout, "Keep-alive: every channel of the hop sequence has to get a frame within the search timeout");
+const byte powerAxisDeadband = 3; // 0.3%, smaller axis changes are noise
+
+const byte POWER_ACTIVE = 0; // full frame rate
+const byte POWER_IDLE = 1; // keep-alive frame rate
+
+byte powerState = POWER_ACTIVE;
+unsigned long powerLastChange; // millis() of the last input change
+unsigned long powerLastFrame; // millis() of the last frame
+
+// Inputs of the last sent frame
+int powerSentAxes[4];
+byte powerSentPot;
+byte powerSentSwitches;
+
+// Latency measurement: from the ADC scan, which delivered the first change, until a frame with it is acknowledged
+boolean powerChangePending = false; // the change wasn't acknowledged yet
+boolean powerChangeInAir = false; // the frame with the change is in the air
+byte powerChangeState; // the state, in which the change was detected
+unsigned long powerChangeMicros;
+
+struct powerSummary {
+  unsigned int framesPerSecond;
+  byte sleep; // CPU sleep ratio in %
+  unsigned int latencyAvg[2], latencyMax[2]; // input to air latency in us (active, idle)
+};
+powerSummary power;
+
+unsigned long powerSleepMicros; // during the current second
+unsigned int powerFrames;
+unsigned long powerLatencySum[2];
+unsigned int powerLatencyCount[2];
+
+//
+// =======================================================================================================
+// FRAME RATE POLICY (called by transmitRadio() in every pass)
+// =======================================================================================================
+//
+
+byte powerSwitches() {
+  return data.mode1 | (data.mode2 << 1) | (data.momentary1 << 2);
+}
+
+boolean powerInputsChanged() {
+  for (byte i = 0; i < 4; i++) {
+    if (abs(axisFine[i] - powerSentAxes[i]) >= powerAxisDeadband) return true;
+  }
+  return data.pot1 != powerSentPot || powerSwitches() != powerSentSwitches;
+}
+
+// Returns true, if a frame has to be sent ----
+boolean powerFrameDue() {
+  if (tdmaActive) return true; // the group mode needs every slot
+
+  if (powerInputsChanged()) {
+    powerLastChange = millis();
+    if (!powerChangePending) {
+      powerChangePending = true;
+      powerChangeState = powerState;
+      powerChangeMicros = adcScanTime(); // the changed inputs are from this scan (or newer button states)
+    }
+    powerState = POWER_ACTIVE;
+  }
+  else if (powerState == POWER_ACTIVE && millis() - powerLastChange > powerIdleDelay) powerState = POWER_IDLE;
+
+  if (powerState == POWER_ACTIVE) return true;
+  return millis() - powerLastFrame >= powerKeepAlive;
+}
+
+// Called after a frame was started ----
+void powerFrameSent() {
+  memcpy(powerSentAxes, axisFine, sizeof(powerSentAxes));
+  powerSentPot = data.pot1;
+  powerSentSwitches = powerSwitches();
+  powerLastFrame = millis();
+  powerFrames ++;
+  powerChangeInAir = powerChangePending;
+}
+
+// Called with the result of a frame (see pollRadio()). A lost change is sent again with the next frame ----
+void powerFrameResult(boolean ok) {
+  if (!powerChangeInAir) return;
+  powerChangeInAir = false;
+  if (!ok) return;
+
+  unsigned long latency = micros() - powerChangeMicros;
+  powerLatencySum[powerChangeState] += latency;
+  powerLatencyCount[powerChangeState] ++;
+  if (latency > power.latencyMax[powerChangeState]) power.latencyMax[powerChangeState] = min(latency, 65535UL);
+  powerChangePending = false;
+}
+
+//
+// =======================================================================================================
+// IDLE SLEEP (until the next interrupt)
+// =======================================================================================================
+//
+
+void powerSleep() {
+  unsigned long start = micros();
+  set_sleep_mode(SLEEP_MODE_IDLE); // timers, ADC, SPI, I2C & Serial are still running
+  sleep_enable();
+  sleep_cpu();
+  sleep_disable();
+  powerSleepMicros += micros() - start;
+}
+
+//
+// =======================================================================================================
+// STATISTICS (every second)
+// =======================================================================================================
+//
+
+void powerUpdate() {
+  static unsigned long lastUpdate;
+  if (millis() - lastUpdate < 1000) return;
+  unsigned long elapsed = millis() - lastUpdate;
+  lastUpdate = millis();
+
+  power.framesPerSecond = powerFrames;
+  power.sleep = min(powerSleepMicros / 10 / elapsed, 100UL);
+  powerFrames = 0;
+  powerSleepMicros = 0;
+
+  for (byte i = 0; i < 2; i++) { // the averages are kept, until there are new measurements
+    if (powerLatencyCount[i] == 0) continue;
+    power.latencyAvg[i] = powerLatencySum[i] / powerLatencyCount[i];
+    powerLatencySum[i] = 0;
+    powerLatencyCount[i] = 0;
+  }
+}
+
+#endif
@@ -0,0 +1,194 @@
+/*
+  Radio protocol for the "Micro RC" transmitter: legacy structs or versioned, bit packed frames
+  Enable the packed protocol with the "PACKED_PROTOCOL" build option (the receiver has to support it!)
+
+  Packed RcData frame (8 bytes, same size as the legacy RcData struct), bits are filled LSB first:
+  - byte 0: marker 0b11 (bit 7, 6), version (bit 5, 4), sequence number (bit 3 - 0)
+    (the marker is > 150, so it can't be mixed up with axis1 of the legacy struct)
+  - 4 x 10 bit axes (0 - 1000 = 0.0 - 100.0%)
+  - mode1, mode2, momentary1 (1 bit each)
+  - pot1 (7 bit, 0 - 100)
+  - hop mask (4 bit, see hopping.h)
+  - data rate request (2 bit, see linkControl.h)
+
+  Packed ACK payload (7 bytes, the legacy ackPayload struct has 10 bytes):
+  - byte 0: marker, version, sequence number echo (same layout as above)
+  - vcc in mV (16 bit), battery voltage in mV (16 bit)
+  - channel (8 bit)
+  - flags: batteryOk (bit 0), data rate confirmation (bit 1, 2), bit 3 - 7 reserved (0)
+
+  The format of the ACK payload is detected by its length. Packed frames of another protocol version are ignored.
+  Created by TheDIYGuy999
+*/
+
+#ifndef protocol_h
+#define protocol_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// PROTOCOL DEFINITIONS
+// =======================================================================================================
+//
+
+const byte packedMarker = 0xC0;
+const byte packedMarkerMask = 0xC0;
+const byte protocolVersion = 1;
+const byte packedFrameSize = 8;
+const byte packedAckSize = 7;
+const byte maxFrameSize = 32; // NRF24L01 maximum payload
+
+byte txSequence = 0; // sequence number of the next frame (4 bit)
+byte rxSequence = 0; // sequence number of the last received frame (radio tester mode)
+boolean rxPacked = false; // the last received frame was packed (radio tester mode)
+byte rxHopMask = 0; // hop mask of the last received frame (radio tester mode)
+byte txRateRequest = 0; // requested data rate code, sent in every frame
+byte rxRateRequest = 0; // data rate request of the last received frame (radio tester mode)
+byte ackRateConfirm = 0; // data rate code, confirmed in the ACK payload (both modes)
+
+//
+// =======================================================================================================
+// BIT PACKING SUBFUNCTIONS (LSB first)
+// =======================================================================================================
+//
+
+void putBits(byte *buf, byte &pos, uint16_t value, byte bits) {
+  for (byte i = 0; i < bits; i++, pos++) {
+    if (value & (1 << i)) buf[pos >> 3] |= (1 << (pos & 0x07));
+    else buf[pos >> 3] &= ~(1 << (pos & 0x07));
+  }
+}
+
+uint16_t getBits(const byte *buf, byte &pos, byte bits) {
+  uint16_t value = 0;
+  for (byte i = 0; i < bits; i++, pos++) {
+    if (buf[pos >> 3] & (1 << (pos & 0x07))) value |= (1 << i);
+  }
+  return value;
+}
+
+// Header byte with marker, version and sequence number ----
+byte packedHeader(byte sequence) {
+  return packedMarker | (protocolVersion << 4) | (sequence & 0x0F);
+}
+
+boolean isPacked(const byte *buf) {
+  return (buf[0] & packedMarkerMask) == packedMarker;
+}
+
+byte packedVersion(const byte *buf) {
+  return (buf[0] >> 4) & 0x03;
+}
+
+//
+// =======================================================================================================
+// RC DATA (transmitter > receiver)
+// =======================================================================================================
+//
+
+// Encode the current data into the transmit buffer, returns the frame length ----
+byte encodeRcData(byte *buf) {
+#ifdef PACKED_PROTOCOL
+  byte pos = 8;
+  buf[0] = packedHeader(txSequence);
+  for (byte i = 0; i < 4; i++) putBits(buf, pos, constrain(axisFine[i], 0, 1000), 10);
+  putBits(buf, pos, data.mode1, 1);
+  putBits(buf, pos, data.mode2, 1);
+  putBits(buf, pos, data.momentary1, 1);
+  putBits(buf, pos, min(data.pot1, 100), 7);
+  putBits(buf, pos, hopMask, 4);
+  putBits(buf, pos, txRateRequest, 2);
+  return packedFrameSize;
+#else
+  memcpy(buf, &data, sizeof(RcData));
+  return sizeof(RcData);
+#endif
+}
+
+// Decode a received frame (both formats) into data, returns false for an unknown protocol version (radio tester mode) ----
+boolean decodeRcData(const byte *buf, byte len) {
+  boolean packed = (len == packedFrameSize && isPacked(buf));
+  if (packed && packedVersion(buf) != protocolVersion) return false; // the frame is ignored
+
+  rxPacked = packed;
+  if (rxPacked) {
+    byte pos = 8;
+    rxSequence = buf[0] & 0x0F;
+    for (byte i = 0; i < 4; i++) axisFine[i] = getBits(buf, pos, 10);
+    data.axis1 = (axisFine[0] + 5) / 10;
+    data.axis2 = (axisFine[1] + 5) / 10;
+    data.axis3 = (axisFine[2] + 5) / 10;
+    data.axis4 = (axisFine[3] + 5) / 10;
+    data.mode1 = getBits(buf, pos, 1);
+    data.mode2 = getBits(buf, pos, 1);
+    data.momentary1 = getBits(buf, pos, 1);
+    data.pot1 = getBits(buf, pos, 7);
+    rxHopMask = getBits(buf, pos, 4);
+    rxRateRequest = getBits(buf, pos, 2);
+    if (rxRateRequest > 2) rxRateRequest = 0; // 3 is not a valid data rate
+  }
+  else {
+    memcpy(&data, buf, min(len, sizeof(RcData)));
+    axisFine[0] = data.axis1 * 10;
+    axisFine[1] = data.axis2 * 10;
+    axisFine[2] = data.axis3 * 10;
+    axisFine[3] = data.axis4 * 10;
+  }
+  return true;
+}
+
+//
+// =======================================================================================================
+// ACK PAYLOAD (receiver > transmitter)
+// =======================================================================================================
+//
+
+// Encode the ACK payload in the format of the last received frame, returns the length (radio tester mode) ----
+byte encodeAck(byte *buf) {
+  if (rxPacked) {
+    byte pos = 8;
+    buf[0] = packedHeader(rxSequence);
+    putBits(buf, pos, payload.vcc, 16); // mV
+    putBits(buf, pos, payload.batteryVoltage, 16);
+    putBits(buf, pos, payload.channel, 8);
+    putBits(buf, pos, payload.batteryOk, 1);
+    putBits(buf, pos, ackRateConfirm, 2);
+    putBits(buf, pos, 0, 5); // reserved
+    return packedAckSize;
+  }
+  ackPayload legacy; // the legacy format uses float voltages
+  legacy.vcc = payload.vcc / 1000.0;
+  legacy.batteryVoltage = payload.batteryVoltage / 1000.0;
+  legacy.batteryOk = payload.batteryOk;
+  legacy.channel = payload.channel;
+  memcpy(buf, &legacy, sizeof(ackPayload));
+  return sizeof(ackPayload);
+}
+
+// Decode a received ACK payload (both formats) into payload, returns false for an unknown protocol version.
+// "echo" is the sequence number echo (0xFF for legacy receivers) ----
+boolean decodeAck(const byte *buf, byte len, byte &echo) {
+  echo = 0xFF;
+  if (len == packedAckSize && isPacked(buf)) {
+    if (packedVersion(buf) != protocolVersion) return false; // the payload is ignored
+    byte pos = 8;
+    payload.vcc = getBits(buf, pos, 16);
+    payload.batteryVoltage = getBits(buf, pos, 16);
+    payload.channel = getBits(buf, pos, 8);
+    payload.batteryOk = getBits(buf, pos, 1);
+    ackRateConfirm = getBits(buf, pos, 2);
+    echo = buf[0] & 0x0F;
+    return true;
+  }
+  ackPayload legacy;
+  memset(&legacy, 0, sizeof(ackPayload));
+  memcpy(&legacy, buf, min(len, sizeof(ackPayload)));
+  payload.vcc = legacy.vcc * 1000 + 0.5; // mV, rounded
+  payload.batteryVoltage = legacy.batteryVoltage * 1000 + 0.5;
+  payload.batteryOk = legacy.batteryOk;
+  payload.channel = legacy.channel;
+  return true;
+}
+
+#endif
@@ -0,0 +1,210 @@
+/*
+  Frame recorder & replay for the "Micro RC" transmitter. Enable it with the "RECORDER" build option.
+  Every frame, which is sent by transmitRadio(), is stored with its time stamp and its result (ACK, retries) in a
+  small RAM ring buffer. The buffer is written via Serial (115200 baud) in the background. Record format (12 bytes):
+  0xA5, time in ms (uint16, little endian), 4 x 10 bit axes (0 - 1000, packed into 5 bytes, little endian),
+  potentiometer, flags, frame counter, checksum (sum of byte 1 - 10).
+  Flags: bit 0 = mode 1, bit 1 = mode 2, bit 2 = momentary 1, bit 3 = ACK received, bit 4 = frame lost,
+  bit 5 - 7 = auto retransmits (max. 7).
+  Replay: records in the same format, which are received via Serial, are replacing the joystick, potentiometer
+  and switch inputs with the original timing (time stamps). The replayed frames are recorded again, so the link
+  behaviour can be compared with the original session. The replay ends 500ms after the last received record.
+  See "tools/recorder.py" for recording & replaying on the PC.
+  Serial is using pins 0 & 1, so the "SEL" & "LEFT" buttons can't be used with this option.
+  Created by TheDIYGuy999
+*/
+
+#ifndef recorder_h
+#define recorder_h
+
+#include "Arduino.h"
+
+#ifdef RECORDER
+
+#if defined DEBUG || defined BENCHMARK || defined LINK_STATS || defined TELEMETRY
+#error "RECORDER can't be combined with the other Serial build options (binary records)"
+#endif
+
+//
+// =======================================================================================================
+// RECORDER SETTINGS & VARIABLES
+// =======================================================================================================
+//
+
+const byte recorderSize = 16; // records per buffer, has to be a power of 2
+const byte recorderSync = 0xA5; // first byte of a record
+const byte recorderLength = 12; // bytes per record (via Serial)
+const unsigned long replayLead = 50; // ms, the received records are buffered before the first one is used
+static_assert(replayLead / 5 < recorderSize - 1, "The replay buffer has to hold the records of the lead time (one per 5ms)");
+const unsigned long replayTimeout = 500; // ms without a record = end of the replay
+
+struct recorderRecord {
+  uint16_t time; // millis() (lower 16 bits)
+  byte axes[5]; // 4 x 10 bit axisFine values
+  byte pot;
+  byte flags;
+  byte counter; // frame counter, a gap = a dropped record (buffer full)
+};
+
+// Recorder (filled by transmitRadio() & pollRadio()) ----
+recorderRecord recorderBuffer[recorderSize];
+byte recorderHead = 0;
+byte recorderTail = 0;
+boolean recorderOpen = false; // the result of the latest record is not yet known
+byte recorderCounter = 0;
+
+// Replay (filled by the received records) ----
+recorderRecord replayBuffer[recorderSize];
+byte replayHead = 0;
+byte replayTail = 0;
+byte replayInput[recorderLength]; // record, which is currently received
+byte replayIndex = 0;
+boolean replayActive = false;
+boolean replayApplied = false; // a record was applied
+recorderRecord replayCurrent; // the inputs of the latest applied record
+unsigned long replayStart; // millis() of the first record
+unsigned long replayOffset; // ms between the first and the next record (original timing)
+uint16_t replayPrevious; // time stamp of the previous record
+unsigned long replayLast; // millis() of the last record
+
+//
+// =======================================================================================================
+// RECORD A FRAME (call it after a frame was started and, when its result is known)
+// =======================================================================================================
+//
+
+void recorderFrame() {
+  byte next = (recorderHead + 1) & (recorderSize - 1);
+  recorderOpen = false; // a frame without result (dropped by the TDMA or discovery start)
+  recorderCounter ++;
+  if (next == recorderTail) return; // buffer full
+
+  recorderRecord &r = recorderBuffer[recorderHead];
+  r.time = millis();
+  unsigned long low = axisFine[0] | ((unsigned long)axisFine[1] << 10) | ((unsigned long)axisFine[2] << 20);
+  r.axes[0] = low;
+  r.axes[1] = low >> 8;
+  r.axes[2] = low >> 16;
+  r.axes[3] = (low >> 24) | (axisFine[3] << 6);
+  r.axes[4] = axisFine[3] >> 2;
+  r.pot = data.pot1;
+  r.flags = data.mode1 | (data.mode2 << 1) | (data.momentary1 << 2);
+  r.counter = recorderCounter;
+
+  recorderHead = next;
+  recorderOpen = true;
+}
+
+void recorderResult(boolean acked, byte retries) {
+  if (!recorderOpen) return;
+  byte last = (recorderHead - 1) & (recorderSize - 1);
+  recorderBuffer[last].flags |= (acked ? 0x08 : 0x10) | (min(retries, 7) << 5);
+  recorderOpen = false;
+}
+
+//
+// =======================================================================================================
+// REPLAY (call it after the inputs were read, it replaces them during the replay)
+// =======================================================================================================
+//
+
+void replayInputs() {
+  if (!replayActive) {
+    if (replayHead == replayTail) return;
+    replayActive = true;
+    replayApplied = false;
+    replayStart = millis() + replayLead;
+    replayOffset = 0;
+    replayPrevious = replayBuffer[replayTail].time;
+    replayLast = millis();
+  }
+
+  // Apply all records, which are due (original timing) ----
+  while (replayHead != replayTail && (long)(millis() - replayStart) >= 0
+         && millis() - replayStart >= replayOffset + (uint16_t)(replayBuffer[replayTail].time - replayPrevious)) {
+    replayOffset += (uint16_t)(replayBuffer[replayTail].time - replayPrevious);
+    replayPrevious = replayBuffer[replayTail].time;
+    replayCurrent = replayBuffer[replayTail];
+    replayTail = (replayTail + 1) & (recorderSize - 1);
+    replayApplied = true;
+  }
+
+  // End of the replay ----
+  if (replayHead == replayTail && millis() - replayLast > replayTimeout) {
+    replayActive = false;
+    return;
+  }
+  if (!replayApplied) return;
+
+  // Replace the inputs ----
+  const byte *a = replayCurrent.axes;
+  axisFine[0] = (a[0] | (a[1] << 8)) & 0x03FF;
+  axisFine[1] = ((a[1] >> 2) | (a[2] << 6)) & 0x03FF;
+  axisFine[2] = ((a[2] >> 4) | (a[3] << 4)) & 0x03FF;
+  axisFine[3] = ((a[3] >> 6) | (a[4] << 2)) & 0x03FF;
+  data.axis1 = (axisFine[0] + 5) / 10;
+  data.axis2 = (axisFine[1] + 5) / 10;
+  data.axis3 = (axisFine[2] + 5) / 10;
+  data.axis4 = (axisFine[3] + 5) / 10;
+  data.pot1 = replayCurrent.pot;
+  data.mode1 = bitRead(replayCurrent.flags, 0);
+  data.mode2 = bitRead(replayCurrent.flags, 1);
+  data.momentary1 = bitRead(replayCurrent.flags, 2);
+}
+
+//
+// =======================================================================================================
+// SERIAL (non blocking, call it regularly)
+// =======================================================================================================
+//
+
+// Checksum of a record ----
+byte recorderChecksum(const byte *buf) {
+  byte sum = 0;
+  for (byte i = 1; i < recorderLength - 1; i++) sum += buf[i];
+  return sum;
+}
+
+void recorderUpdate() {
+
+  // Send the completed records ----
+  while (recorderTail != recorderHead && Serial.availableForWrite() >= recorderLength) {
+    if (recorderOpen && ((recorderTail + 1) & (recorderSize - 1)) == recorderHead) break; // the result is missing
+    const recorderRecord &r = recorderBuffer[recorderTail];
+    byte buf[recorderLength];
+    buf[0] = recorderSync;
+    buf[1] = r.time;
+    buf[2] = r.time >> 8;
+    memcpy(&buf[3], r.axes, 5);
+    buf[8] = r.pot;
+    buf[9] = r.flags;
+    buf[10] = r.counter;
+    buf[11] = recorderChecksum(buf);
+    Serial.write(buf, recorderLength);
+    recorderTail = (recorderTail + 1) & (recorderSize - 1);
+  }
+
+  // Receive the records for the replay ----
+  while (Serial.available()) {
+    byte b = Serial.read();
+    if (replayIndex == 0 && b != recorderSync) continue; // search the start of a record
+    replayInput[replayIndex++] = b;
+    if (replayIndex < recorderLength) continue;
+    replayIndex = 0;
+
+    byte next = (replayHead + 1) & (recorderSize - 1);
+    if (recorderChecksum(replayInput) != replayInput[recorderLength - 1] || next == replayTail) continue; // invalid or buffer full
+    recorderRecord &r = replayBuffer[replayHead];
+    r.time = replayInput[1] | (replayInput[2] << 8);
+    memcpy(r.axes, &replayInput[3], 5);
+    r.pot = replayInput[8];
+    r.flags = replayInput[9];
+    r.counter = replayInput[10];
+    replayHead = next;
+    replayLast = millis();
+  }
+}
+
+#endif
+
+#endif
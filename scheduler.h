@@ -0,0 +1,107 @@
+/*
+  A tiny cooperative fixed rate task scheduler for the "Micro RC" transmitter.
+  The task table is ordered by priority: the first entry has the highest priority.
+  Only one task is executed per scheduler pass, so a due high priority task never has to wait for more than
+  one lower priority task.
+  Created by TheDIYGuy999
+*/
+
+#ifndef scheduler_h
+#define scheduler_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// TASK DEFINITION
+// =======================================================================================================
+//
+
+struct schedulerTask {
+  const __FlashStringHelper *name; // short task name for the diagnostics screen (max. 5 characters, in flash)
+  void (*function)(); // the task function
+  unsigned long period; // in microseconds (0 = background task, executed, if no other task is due)
+  boolean enabled;
+  unsigned long nextStart; // the next scheduled start time in microseconds
+  unsigned long runs; // number of executions
+  unsigned int wcet; // worst case execution time in microseconds
+  unsigned int jitter; // worst case start delay (compared with the scheduled start time) in microseconds
+};
+
+//
+// =======================================================================================================
+// SCHEDULER (call it from the main loop)
+// =======================================================================================================
+//
+
+void runScheduler(schedulerTask tasks[], byte count) {
+
+  unsigned long now = micros();
+
+  for (byte i = 0; i < count; i++) {
+    if (!tasks[i].enabled) continue;
+
+    if (tasks[i].period > 0) { // Fixed rate task ----
+      long lateness = now - tasks[i].nextStart;
+      if (lateness < 0) continue; // not due yet
+
+      if ((unsigned long)lateness > tasks[i].jitter) tasks[i].jitter = min((unsigned long)lateness, 65535UL);
+
+      // Schedule the next start based on the previous schedule, so the rate does not drift
+      tasks[i].nextStart += tasks[i].period;
+      if ((long)(now - tasks[i].nextStart) >= 0) tasks[i].nextStart = now + tasks[i].period; // more than one period late, resync
+    }
+
+    // Execute the task and measure the execution time ----
+    tasks[i].function();
+    unsigned long duration = micros() - now;
+    if (duration > tasks[i].wcet) tasks[i].wcet = min(duration, 65535UL);
+    tasks[i].runs ++;
+
+    return; // only one task per pass, start again with the highest priority one
+  }
+}
+
+// Is a fixed rate task due? (if not, the CPU can sleep until the next interrupt) ----
+boolean schedulerDue(schedulerTask tasks[], byte count) {
+
+  unsigned long now = micros();
+
+  for (byte i = 0; i < count; i++) {
+    if (tasks[i].enabled && tasks[i].period > 0 && (long)(now - tasks[i].nextStart) >= 0) return true;
+  }
+  return false;
+}
+
+//
+// =======================================================================================================
+// TASK SETUP
+// =======================================================================================================
+//
+
+void setTask(schedulerTask &task, const __FlashStringHelper *name, void (*function)(), unsigned long period, boolean enabled) {
+  task.name = name;
+  task.function = function;
+  task.period = period;
+  task.enabled = enabled;
+}
+
+//
+// =======================================================================================================
+// START THE SCHEDULER (all tasks are due immediately)
+// =======================================================================================================
+//
+
+void startScheduler(schedulerTask tasks[], byte count) {
+
+  unsigned long now = micros();
+
+  for (byte i = 0; i < count; i++) {
+    tasks[i].nextStart = now;
+    tasks[i].runs = 0;
+    tasks[i].wcet = 0;
+    tasks[i].jitter = 0;
+  }
+}
+
+#endif
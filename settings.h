@@ -0,0 +1,267 @@
+/*
+  Journaled vehicle settings store for the "Micro RC" transmitter (AVR EEPROM)
+
+  One 16 byte record per vehicle (reversing & travel adjustments), protected by a CRC16. New records are appended
+  to a journal in the free EEPROM after the legacy blocks, so all slots are worn evenly. The latest record of a
+  vehicle is never overwritten, before a newer one is completely written: a power loss during a write just
+  leaves an invalid record behind, and the previous one is still valid.
+  Records are written in the background, one byte per settings task call, only if the EEPROM is ready (no waiting).
+  Saves are queued, a new save of a vehicle replaces its queued record. A save never waits: if the records of other
+  vehicles fill the queue, the newest one is replaced. An unchanged record is not written at all.
+  Only the settings of the active vehicle are kept in RAM. Vehicles without a record are read from the legacy layout
+  (and migrated into the journal with the next change).
+  Created by TheDIYGuy999
+*/
+
+#ifndef settings_h
+#define settings_h
+
+#include "Arduino.h"
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+//
+// =======================================================================================================
+// SETTINGS STORE LAYOUT & VARIABLES
+// =======================================================================================================
+//
+
+// Record layout (16 bytes):
+// 0: marker & version, 1: vehicle number, 2 - 3: sequence number, 4: reversed channels (bit 0 - 3),
+// 5 - 8: travel negative, 9 - 12: travel positive, 13: reserved, 14 - 15: CRC16 of byte 0 - 13
+const byte settingsVersion = 0xA1; // change it, if the record layout is changed!
+const byte settingsRecordSize = 16;
+const int settingsStart = 256; // after the 3 legacy blocks of 84 bytes
+const byte settingsSlots = (E2END + 1 - settingsStart) / settingsRecordSize; // 48 slots @ 1kB EEPROM
+static_assert(settingsSlots > maxVehicleNumber, "The journal needs at least one free slot");
+
+const byte settingsNone = 0xFF;
+byte settingsSlot[maxVehicleNumber + 1]; // slot of the latest record of each vehicle (settingsNone = no record)
+byte settingsHead = 0; // the next slot to write
+uint16_t settingsSequence = 0; // sequence number of the latest record
+
+const byte settingsQueueSize = 2; // records of different vehicles, which are waiting for the write (160ms each)
+byte settingsQueue[settingsQueueSize][settingsRecordSize]; // [0] is written next
+byte settingsQueued = 0; // number of waiting records
+byte settingsRecord[settingsRecordSize]; // the record, which is written now
+byte settingsWriteSlot = settingsNone; // its slot
+byte settingsWriteIndex = 0; // the next byte to write
+
+//
+// =======================================================================================================
+// RECORD SUBFUNCTIONS
+// =======================================================================================================
+//
+
+int settingsAddress(byte slot) {
+  return settingsStart + slot * settingsRecordSize;
+}
+
+uint16_t settingsCrc(const byte *record) {
+  uint16_t crc = 0xFFFF;
+  for (byte i = 0; i < settingsRecordSize - 2; i++) crc = _crc_ccitt_update(crc, record[i]);
+  return crc;
+}
+
+// Read a slot, returns true, if it contains a valid record ----
+boolean settingsRead(byte slot, byte *record) {
+  eeprom_read_block(record, (const void *)(uintptr_t)settingsAddress(slot), settingsRecordSize);
+  if (record[0] != settingsVersion || record[1] > maxVehicleNumber) return false;
+  return settingsCrc(record) == (record[14] | (record[15] << 8));
+}
+
+uint16_t settingsRecordSequence(const byte *record) {
+  return record[2] | (record[3] << 8);
+}
+
+// The queued record of a vehicle, NULL if none ----
+byte *settingsQueuedRecord(byte vehicle) {
+  for (byte i = 0; i < settingsQueued; i++) {
+    if (settingsQueue[i][1] == vehicle) return settingsQueue[i];
+  }
+  return NULL;
+}
+
+// The latest record of a vehicle: queued, being written or in the journal. Returns false, if there is none ----
+boolean settingsLatest(byte vehicle, byte *record) {
+  byte *queued = settingsQueuedRecord(vehicle);
+  if (queued) memcpy(record, queued, settingsRecordSize);
+  else if (settingsWriteSlot != settingsNone && settingsRecord[1] == vehicle) memcpy(record, settingsRecord, settingsRecordSize);
+  else return settingsSlot[vehicle] != settingsNone && settingsRead(settingsSlot[vehicle], record);
+  return true;
+}
+
+//
+// =======================================================================================================
+// SCAN THE JOURNAL (call it once during setup)
+// =======================================================================================================
+//
+
+void settingsScan() {
+  byte record[settingsRecordSize];
+  uint16_t vehicleSequence[maxVehicleNumber + 1];
+  boolean first = true;
+
+  memset(settingsSlot, settingsNone, sizeof(settingsSlot));
+
+  for (byte slot = 0; slot < settingsSlots; slot++) {
+    if (!settingsRead(slot, record)) continue;
+    byte vehicle = record[1];
+    uint16_t sequence = settingsRecordSequence(record);
+
+    // The latest record of each vehicle (the sequence numbers of a vehicle are close together, so the wrap is no problem)
+    if (settingsSlot[vehicle] == settingsNone || (int16_t)(sequence - vehicleSequence[vehicle]) > 0) {
+      settingsSlot[vehicle] = slot;
+      vehicleSequence[vehicle] = sequence;
+    }
+
+    // The latest record of all, the journal continues after it
+    if (first || (int16_t)(sequence - settingsSequence) > 0) {
+      settingsSequence = sequence;
+      settingsHead = slot + 1;
+      first = false;
+    }
+  }
+  if (settingsHead >= settingsSlots) settingsHead = 0;
+}
+
+//
+// =======================================================================================================
+// LOAD THE SETTINGS OF A VEHICLE (on demand)
+// =======================================================================================================
+//
+
+// Into "s" (the settings of other vehicles are used by the TDMA group mode) ----
+void settingsLoad(byte vehicle, vehicleSettings &s) {
+  byte record[settingsRecordSize];
+
+  if (settingsLatest(vehicle, record)) { // journal record (or a record, which isn't written yet)
+    s.reversed = record[4] & 0x0F;
+    memcpy(s.percentNegative, &record[5], 4);
+    memcpy(s.percentPositive, &record[9], 4);
+  }
+  else if (EEPROM.readByte(addressReverse) == 0) { // no record, but a valid legacy layout
+    s.reversed = 0;
+    for (byte i = 0; i < 4; i++) {
+      if (EEPROM.readByte(addressReverse + vehicle * 4 + i)) bitSet(s.reversed, i);
+      s.percentNegative[i] = EEPROM.readByte(addressNegative + vehicle * 4 + i);
+      s.percentPositive[i] = EEPROM.readByte(addressPositive + vehicle * 4 + i);
+    }
+  }
+  else { // defaults
+    s.reversed = 0;
+    memset(s.percentNegative, 100, 4);
+    memset(s.percentPositive, 100, 4);
+  }
+
+  // Limit the values (corrupted legacy data)
+  for (byte i = 0; i < 4; i++) {
+    s.percentNegative[i] = constrain(s.percentNegative[i], 20, 100);
+    s.percentPositive[i] = constrain(s.percentPositive[i], 20, 100);
+  }
+}
+
+// Into the settings of the active vehicle ----
+void settingsLoad(byte vehicle) {
+  settingsLoad(vehicle, settings);
+}
+
+//
+// =======================================================================================================
+// SAVE THE SETTINGS OF A VEHICLE (deferred, written by the settings task)
+// =======================================================================================================
+//
+
+void settingsSave(byte vehicle) {
+  byte record[settingsRecordSize];
+  record[4] = settings.reversed;
+  memcpy(&record[5], settings.percentNegative, 4);
+  memcpy(&record[9], settings.percentPositive, 4);
+  record[13] = 0;
+
+  // Unchanged: no EEPROM write ----
+  byte latest[settingsRecordSize];
+  if (settingsLatest(vehicle, latest) && memcmp(&record[4], &latest[4], 10) == 0) return;
+
+  // A queued record of this vehicle is replaced, otherwise the record is added to the queue. Queue full (saves of
+  // more vehicles within 160ms, not possible with the menu): the newest record is replaced, the oldest one is kept ----
+  byte *queued = settingsQueuedRecord(vehicle);
+  if (!queued) {
+    if (settingsQueued < settingsQueueSize) settingsQueued ++;
+    queued = settingsQueue[settingsQueued - 1];
+  }
+
+  settingsSequence ++;
+  record[0] = settingsVersion;
+  record[1] = vehicle;
+  record[2] = lowByte(settingsSequence);
+  record[3] = highByte(settingsSequence);
+  uint16_t crc = settingsCrc(record);
+  record[14] = lowByte(crc);
+  record[15] = highByte(crc);
+  memcpy(queued, record, settingsRecordSize);
+}
+
+// Take over the oldest queued record and find a free slot ----
+void settingsPrepare() {
+  memcpy(settingsRecord, settingsQueue[0], settingsRecordSize);
+  settingsQueued --;
+  memmove(settingsQueue[0], settingsQueue[1], settingsQueued * settingsRecordSize);
+
+  // Skip the slots with the latest record of a vehicle (there are always free ones)
+  for (;;) {
+    boolean used = false;
+    for (byte v = 0; v <= maxVehicleNumber; v++) {
+      if (settingsSlot[v] == settingsHead) used = true;
+    }
+    if (!used) break;
+    settingsHead ++;
+    if (settingsHead >= settingsSlots) settingsHead = 0;
+  }
+
+  settingsWriteSlot = settingsHead;
+  settingsWriteIndex = 0;
+}
+
+//
+// =======================================================================================================
+// SETTINGS TASK (one byte per call, never waits for the EEPROM)
+// =======================================================================================================
+//
+
+void settingsTask() {
+
+  if (!eeprom_is_ready()) return; // the previous byte is still being written
+
+  // Nothing to write: start the oldest queued record ----
+  if (settingsWriteSlot == settingsNone) {
+    if (settingsQueued) settingsPrepare();
+    return;
+  }
+
+  // Write the next byte (the CRC is written last, so an incomplete record is invalid) ----
+  eeprom_update_byte((uint8_t *)(uintptr_t)(settingsAddress(settingsWriteSlot) + settingsWriteIndex), settingsRecord[settingsWriteIndex]);
+  settingsWriteIndex ++;
+
+  if (settingsWriteIndex >= settingsRecordSize) { // complete: this is the latest record of the vehicle now
+    settingsSlot[settingsRecord[1]] = settingsWriteSlot;
+    settingsHead = settingsWriteSlot + 1;
+    if (settingsHead >= settingsSlots) settingsHead = 0;
+    settingsWriteSlot = settingsNone;
+  }
+}
+
+//
+// =======================================================================================================
+// RESET ALL SETTINGS TO THE DEFAULTS (during setup only, blocking)
+// =======================================================================================================
+//
+
+void settingsReset() {
+  for (byte slot = 0; slot < settingsSlots; slot++) eeprom_update_byte((uint8_t *)(uintptr_t)settingsAddress(slot), 0xFF); // invalidate all records
+  EEPROM.updateByte(addressReverse, 0xFF); // invalidate the legacy layout
+  memset(settingsSlot, settingsNone, sizeof(settingsSlot));
+  settingsQueued = 0;
+}
+
+#endif
@@ -0,0 +1,189 @@
+/*
+  Time sliced multi vehicle control (TDMA) for the "Micro RC" transmitter
+  The frames of the control task are sent to the vehicles of a group in a row (one frame = one time slot of 5ms).
+  Every vehicle has its own sequence number, so the packed protocol receivers are following the hop sequence.
+  The retries are limited, so a frame always fits into its slot: every vehicle gets 200Hz / number of vehicles.
+  The group is limited to 8 vehicles, so the update rate is never lower than 25Hz.
+  The joystick data is adapted to the reversing & travel settings of each vehicle (if "tdmaVehicleSettings" is true).
+  The group is chosen in the vehicle discovery list. The data rate is fixed to 250kbps.
+  The ACK payload and the time of the last ACK are kept per vehicle, so the link is lost, if one vehicle doesn't answer.
+  Created by TheDIYGuy999
+*/
+
+#ifndef tdma_h
+#define tdma_h
+
+#include "Arduino.h"
+
+//
+// =======================================================================================================
+// TDMA SETTINGS & VARIABLES
+// =======================================================================================================
+//
+
+const boolean tdmaVehicleSettings = true; // false = the data of the active vehicle is sent to all vehicles
+
+const unsigned int tdmaFrameRate = 200; // Hz, see the control task in setupTasks()
+const byte tdmaMinRate = 25; // Hz, min. update rate of every vehicle
+const byte tdmaMaxVehicles = tdmaFrameRate / tdmaMinRate; // 8
+const unsigned long tdmaTimeout = 4000; // us, a frame is dropped, before the next slot starts (max. 2 x 1.65ms @ 250kbps)
+
+boolean tdmaActive = false;
+unsigned long tdmaGroup = 0; // bit 0 - 19 = vehicle 1 - 20 is a member of the group
+byte tdmaCount = 0; // number of vehicles
+byte tdmaSlot = 0; // the vehicle of the current frame (index)
+byte tdmaVehicle[tdmaMaxVehicles]; // vehicle numbers (1 - 20)
+vehicleSettings tdmaSettings[tdmaMaxVehicles]; // reversing & travel of each vehicle
+byte tdmaSequence[tdmaMaxVehicles]; // the next sequence number of each vehicle
+
+struct tdmaVehicleStats {
+  byte acked; // acknowledged frames during the current second
+  byte rate; // acknowledged frames per second (the achieved update rate, max. 200Hz / number of vehicles)
+  unsigned long lastAck; // millis() of the last ACK with payload
+  telemetryData payload; // the last ACK payload of the vehicle
+};
+tdmaVehicleStats tdmaStats[tdmaMaxVehicles];
+
+//
+// =======================================================================================================
+// GROUP MEMBERS
+// =======================================================================================================
+//
+
+byte tdmaMembers() {
+  byte count = 0;
+  for (byte i = 0; i < maxVehicleNumber; i++) {
+    if (bitRead(tdmaGroup, i)) count ++;
+  }
+  return count;
+}
+
+// Add or remove a vehicle (0 = vehicle 1) ----
+void tdmaToggle(byte vehicle) {
+  if (bitRead(tdmaGroup, vehicle)) bitClear(tdmaGroup, vehicle);
+  else if (tdmaMembers() < tdmaMaxVehicles) bitSet(tdmaGroup, vehicle);
+}
+
+//
+// =======================================================================================================
+// START & STOP (the joystick transforms have to be rebuilt afterwards)
+// =======================================================================================================
+//
+
+// Returns false, if the group has less than 2 vehicles ----
+boolean tdmaStart() {
+  tdmaCount = 0;
+  for (byte i = 0; i < maxVehicleNumber; i++) {
+    if (!bitRead(tdmaGroup, i)) continue;
+    tdmaVehicle[tdmaCount] = i + 1;
+    if (i + 1 == vehicleNumber) tdmaSettings[tdmaCount] = settings; // the active vehicle (may be changed in the menu)
+    else settingsLoad(i + 1, tdmaSettings[tdmaCount]); // includes the records, which aren't written yet
+    tdmaSequence[tdmaCount] = 0;
+    tdmaStats[tdmaCount] = tdmaVehicleStats();
+    tdmaCount ++;
+  }
+  if (tdmaCount < 2) return false;
+
+  if (txBusy) radio.flush_tx();
+  txBusy = false;
+  resetLinkControl(); // no data rate negotiation with several receivers
+  radio.setRetries(3, 1); // 1000us delay, 1 retry: max. 2 x 1.65ms @ 250kbps
+  tdmaSlot = tdmaCount - 1; // the first frame is sent to the first vehicle
+  tdmaActive = true;
+  return true;
+}
+
+// The pipe address of the active vehicle has to be restored afterwards ----
+void tdmaStop() {
+  if (txBusy) radio.flush_tx();
+  txBusy = false;
+  radio.setRetries(5, 5); // see setupRadio()
+  tdmaActive = false;
+}
+
+//
+// =======================================================================================================
+// NEXT SLOT (called before a frame is sent)
+// =======================================================================================================
+//
+
+void tdmaNext() {
+  tdmaSequence[tdmaSlot] = txSequence; // every vehicle has its own sequence number
+  tdmaSlot ++;
+  if (tdmaSlot >= tdmaCount) tdmaSlot = 0;
+  txSequence = tdmaSequence[tdmaSlot];
+  radio.openWritingPipe(pgm_read_64(&pipeOut, tdmaVehicle[tdmaSlot] - 1));
+}
+
+// Joystick data with the reversing & travel of a vehicle (the transforms are delivering 0 - 1000 without them) ----
+int tdmaAxis(int value, byte axis, const vehicleSettings &s) {
+  int span = (long)value * (s.percentNegative[axis] + s.percentPositive[axis]) / 200;
+  if (bitRead(s.reversed, axis)) return 500 + s.percentPositive[axis] * 5 - span;
+  return 500 - s.percentNegative[axis] * 5 + span;
+}
+
+byte tdmaEncode(byte *buf) {
+  if (!tdmaVehicleSettings) return encodeRcData(buf);
+
+  RcData active = data;
+  int activeFine[4];
+  memcpy(activeFine, axisFine, sizeof(axisFine));
+  for (byte i = 0; i < 4; i++) axisFine[i] = tdmaAxis(axisFine[i], i, tdmaSettings[tdmaSlot]);
+  data.axis1 = (axisFine[0] + 5) / 10;
+  data.axis2 = (axisFine[1] + 5) / 10;
+  data.axis3 = (axisFine[2] + 5) / 10;
+  data.axis4 = (axisFine[3] + 5) / 10;
+
+  byte len = encodeRcData(buf);
+
+  data = active;
+  memcpy(axisFine, activeFine, sizeof(axisFine));
+  return len;
+}
+
+//
+// =======================================================================================================
+// ACKNOWLEDGED FRAME (called by pollRadio())
+// =======================================================================================================
+//
+
+// The ACK payload of the current vehicle, the global payload isn't changed ----
+void tdmaAck(const byte *ack, byte len) {
+  telemetryData active = payload;
+  byte echo;
+  if (decodeAck(ack, len, echo)) {
+    tdmaStats[tdmaSlot].payload = payload;
+    tdmaStats[tdmaSlot].lastAck = millis();
+  }
+  payload = active;
+}
+
+void tdmaResult() {
+  tdmaStats[tdmaSlot].acked ++;
+}
+
+// millis() of the oldest last ACK of all vehicles ----
+unsigned long tdmaLastAck() {
+  unsigned long oldest = millis();
+  for (byte i = 0; i < tdmaCount; i++) {
+    if (millis() - tdmaStats[i].lastAck > millis() - oldest) oldest = tdmaStats[i].lastAck;
+  }
+  return oldest;
+}
+
+// Update rate of every vehicle (every second) ----
+void tdmaUpdate() {
+  static unsigned long lastUpdate;
+  if (millis() - lastUpdate < 1000) return;
+  lastUpdate = millis();
+
+  boolean batteryOk = true;
+  for (byte i = 0; i < tdmaCount; i++) {
+    tdmaStats[i].rate = tdmaStats[i].acked;
+    tdmaStats[i].acked = 0;
+    if (millis() - tdmaStats[i].lastAck < 1000 && !tdmaStats[i].payload.batteryOk) batteryOk = false;
+  }
+  payload.batteryOk = batteryOk; // the red LED is on, if the battery of a vehicle is low
+}
+
+#endif
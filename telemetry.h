@@ -0,0 +1,221 @@
+/*
+  Binary telemetry stream for the "Micro RC" transmitter. Enable it with the "TELEMETRY" build option.
+  Small records are sent via Serial (115200 baud): the axes of every sent (or, in radio tester mode, received) frame
+  and once per second the link statistics, the battery state and the timing. A record is only written, if it fits
+  into the Serial transmit buffer (sent by the UART interrupt), otherwise it's dropped. So the transmitter is never
+  blocked and behaves like without this option (it can stay enabled in the field).
+  Frame: COBS encoded (no 0x00 inside), terminated with 0x00. Content (little endian): type, sequence number (a gap =
+  dropped records), time in ms (uint16), payload (see below), CRC16 (CCITT, init 0xFFFF, over all previous bytes).
+  See "tools/telemetry.py" for the CSV converter on the PC.
+  Serial is using pins 0 & 1, so the "SEL" & "LEFT" buttons can't be used with this option.
+  Created by TheDIYGuy999
+*/
+
+#ifndef telemetry_h
+#define telemetry_h
+
+#include "Arduino.h"
+
+#ifdef TELEMETRY
+
+#if defined DEBUG || defined BENCHMARK || defined LINK_STATS || defined RECORDER
+#error "TELEMETRY can't be combined with the other Serial build options (binary stream)"
+#endif
+
+#include <util/crc16.h>
+
+//
+// =======================================================================================================
+// RECORD TYPES (the payloads, the PC tool has to match! The AVR compiler adds no padding bytes)
+// =======================================================================================================
+//
+
+enum {
+  TELEMETRY_AXES = 1,
+  TELEMETRY_LINK,
+  TELEMETRY_BATTERY,
+  TELEMETRY_TIMING,
+  TELEMETRY_RX
+};
+
+struct telemetryAxes { // every sent or received frame
+  byte axes[5]; // 4 x 10 bit axisFine values, packed
+  byte pot;
+  byte flags; // bit 0 = mode 1, bit 1 = mode 2, bit 2 = momentary 1, bit 3 = received frame (radio tester)
+};
+
+struct telemetryLink { // every second (transmitter)
+  uint16_t sentPerSecond, ackedPerSecond;
+  byte loss; // %
+  byte retries; // average * 10
+  uint16_t rtt50, rtt90, rttMax; // us
+  uint16_t ackLost;
+  byte rate; // data rate code
+  byte pa; // PA level
+};
+
+struct telemetryBattery { // every second
+  uint16_t txMillivolts, txVcc;
+  byte txSoc; // %
+  uint16_t txRuntime; // minutes (0xFFFF = not yet known)
+  uint16_t vehicleMillivolts, vehicleVcc;
+  byte vehicleSoc;
+  uint16_t vehicleRuntime;
+  byte flags; // bit 0 = transmitter battery OK, bit 1 = vehicle battery OK
+};
+
+struct telemetryTiming { // every second
+  uint16_t framesPerSecond;
+  byte sleep; // CPU sleep %
+  uint16_t controlWcet, controlJitter; // control task, us
+  uint16_t latency; // average input to air latency, us
+  uint16_t dropped; // telemetry records, since power on
+};
+
+struct telemetryRx { // every second (radio tester)
+  uint16_t rate; // received frames per second
+  uint16_t lost;
+  uint32_t frames;
+  byte channel;
+};
+
+//
+// =======================================================================================================
+// TELEMETRY VARIABLES
+// =======================================================================================================
+//
+
+const byte telemetryHeader = 4; // type, sequence, time
+const byte telemetryMaxPayload = sizeof(telemetryLink); // the largest payload
+const byte telemetryMaxFrame = telemetryHeader + telemetryMaxPayload + 2 + 2; // CRC, COBS code & delimiter
+
+byte telemetrySequence = 0;
+uint16_t telemetryDropped = 0;
+
+//
+// =======================================================================================================
+// SEND A RECORD (COBS framing, dropped, if the Serial buffer is too full)
+// =======================================================================================================
+//
+
+void telemetrySend(byte type, const void *payload, byte len) {
+  byte raw[telemetryHeader + telemetryMaxPayload + 2];
+  uint16_t time = millis();
+  raw[0] = type;
+  raw[1] = telemetrySequence++;
+  raw[2] = lowByte(time);
+  raw[3] = highByte(time);
+  memcpy(&raw[telemetryHeader], payload, len);
+  len += telemetryHeader;
+
+  uint16_t crc = 0xFFFF;
+  for (byte i = 0; i < len; i++) crc = _crc_ccitt_update(crc, raw[i]);
+  raw[len++] = lowByte(crc);
+  raw[len++] = highByte(crc);
+
+  // COBS: every 0x00 is replaced with the distance to the next one (the frame is shorter than 254 bytes) ----
+  byte frame[telemetryMaxFrame];
+  byte code = 1;
+  byte codeIndex = 0;
+  byte out = 1;
+  for (byte i = 0; i < len; i++) {
+    if (raw[i] == 0) {
+      frame[codeIndex] = code;
+      codeIndex = out++;
+      code = 1;
+    }
+    else {
+      frame[out++] = raw[i];
+      code ++;
+    }
+  }
+  frame[codeIndex] = code;
+  frame[out++] = 0; // delimiter
+
+  if (Serial.availableForWrite() < out) { // backpressure: never wait
+    telemetryDropped ++;
+    return;
+  }
+  Serial.write(frame, out);
+}
+
+//
+// =======================================================================================================
+// RECORDS
+// =======================================================================================================
+//
+
+// Axes of a sent or received frame ----
+void telemetryFrame(boolean received) {
+  telemetryAxes r;
+  unsigned long low = axisFine[0] | ((unsigned long)axisFine[1] << 10) | ((unsigned long)axisFine[2] << 20);
+  r.axes[0] = low;
+  r.axes[1] = low >> 8;
+  r.axes[2] = low >> 16;
+  r.axes[3] = (low >> 24) | (axisFine[3] << 6);
+  r.axes[4] = axisFine[3] >> 2;
+  r.pot = data.pot1;
+  r.flags = data.mode1 | (data.mode2 << 1) | (data.momentary1 << 2) | (received << 3);
+  telemetrySend(TELEMETRY_AXES, &r, sizeof(r));
+}
+
+// Link, battery & timing, every second (call it regularly). One record per call, so the Serial buffer can't overflow ----
+void telemetryUpdate(const schedulerTask &control) {
+  static unsigned long lastUpdate;
+  static byte next;
+  if (millis() - lastUpdate < 333) return;
+  lastUpdate = millis();
+  next = (next < 2) ? next + 1 : 0;
+
+  if (next == 0 && operationMode == 0) {
+    telemetryLink l;
+    l.sentPerSecond = linkStats.sentPerSecond;
+    l.ackedPerSecond = linkStats.ackedPerSecond;
+    l.loss = linkStats.loss;
+    l.retries = linkStats.retries;
+    l.rtt50 = linkStats.rtt50;
+    l.rtt90 = linkStats.rtt90;
+    l.rttMax = linkStats.rttMax;
+    l.ackLost = linkStats.ackLost;
+    l.rate = radioRate;
+    l.pa = min(linkLevels[linkLevelNow].pa, paLimit);
+    telemetrySend(TELEMETRY_LINK, &l, sizeof(l));
+  }
+  if (next == 0 && operationMode == 1) {
+    telemetryRx r;
+    r.rate = analyzerRate;
+    r.lost = analyzerLost;
+    r.frames = analyzerPackets;
+    r.channel = payload.channel;
+    telemetrySend(TELEMETRY_RX, &r, sizeof(r));
+  }
+
+  if (next == 1) {
+    telemetryBattery b;
+    b.txMillivolts = txBatt;
+    b.txVcc = txVcc;
+    b.txSoc = txBattery.soc;
+    b.txRuntime = txBattery.runtime;
+    b.vehicleMillivolts = payload.batteryVoltage;
+    b.vehicleVcc = payload.vcc;
+    b.vehicleSoc = vehicleBattery.soc;
+    b.vehicleRuntime = vehicleBattery.runtime;
+    b.flags = batteryOkTx | (payload.batteryOk << 1);
+    telemetrySend(TELEMETRY_BATTERY, &b, sizeof(b));
+  }
+
+  if (next == 2) {
+    telemetryTiming t;
+    t.framesPerSecond = power.framesPerSecond;
+    t.sleep = power.sleep;
+    t.controlWcet = control.wcet;
+    t.controlJitter = control.jitter;
+    t.latency = power.latencyAvg[POWER_ACTIVE];
+    t.dropped = telemetryDropped;
+    telemetrySend(TELEMETRY_TIMING, &t, sizeof(t));
+  }
+}
+
+#endif
+
+#endif
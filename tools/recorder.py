@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Frame recorder & replay for the "Micro RC" transmitter (PC side, see "recorder.h").
+Requires pyserial ("pip install pyserial") and a transmitter with the "RECORDER" build option.
+
+  Record a session:   recorder.py record /dev/ttyUSB0 session.bin
+  Replay it:          recorder.py replay /dev/ttyUSB0 session.bin replayed.bin
+  Show a recording:   recorder.py show session.bin
+
+The replay sends the records with their original timing. The transmitter buffers them for 50ms ("replayLead" in
+recorder.h), so the PC timing jitter doesn't matter. The replayed frames are recorded again into the second file.
+Created by TheDIYGuy999
+"""
+
+import sys
+import threading
+import time
+
+SYNC = 0xA5
+LENGTH = 12
+
+
+def records(data):
+    """Valid records of a byte stream (the stream is resynchronized after an invalid record)."""
+    i = 0
+    while i + LENGTH <= len(data):
+        rec = data[i:i + LENGTH]
+        if rec[0] == SYNC and sum(rec[1:LENGTH - 1]) & 0xFF == rec[LENGTH - 1]:
+            yield bytes(rec)
+            i += LENGTH
+        else:
+            i += 1
+
+
+def decode(rec):
+    axes = int.from_bytes(rec[3:8], "little")
+    flags = rec[9]
+    return {
+        "time": rec[1] | (rec[2] << 8),
+        "axes": [(axes >> (10 * n)) & 0x3FF for n in range(4)],
+        "pot": rec[8],
+        "switches": flags & 0x07,
+        "ack": bool(flags & 0x08),
+        "lost": bool(flags & 0x10),
+        "retries": flags >> 5,
+        "counter": rec[10],
+    }
+
+
+def summary(recs):
+    frames = [decode(r) for r in recs]
+    if not frames:
+        return "no records"
+    acked = sum(f["ack"] for f in frames)
+    lost = sum(f["lost"] for f in frames)
+    dropped = sum((b["counter"] - a["counter"] - 1) & 0xFF for a, b in zip(frames, frames[1:]))
+    duration = sum((b["time"] - a["time"]) & 0xFFFF for a, b in zip(frames, frames[1:]))
+    retries = sum(f["retries"] for f in frames if f["ack"])
+    return "%d frames, %.1fs, %d acked, %d lost, %.2f retries per ACK, %d records dropped" % (
+        len(frames), duration / 1000.0, acked, lost, retries / max(acked, 1), dropped)
+
+
+def capture(port, out, stop):
+    while not stop.is_set():
+        data = port.read(256)
+        if data:
+            out.write(data)
+
+
+def main(args):
+    if len(args) >= 2 and args[0] == "show":
+        with open(args[1], "rb") as f:
+            recs = list(records(f.read()))
+        for r in recs:
+            d = decode(r)
+            print("%5d %4d %4d %4d %4d %3d %d %s r%d #%d" % (
+                d["time"], *d["axes"], d["pot"], d["switches"],
+                "ACK " if d["ack"] else ("lost" if d["lost"] else "-   "), d["retries"], d["counter"]))
+        print(summary(recs))
+        return 0
+
+    import serial
+    if len(args) >= 3 and args[0] == "record":
+        with serial.Serial(args[1], 115200, timeout=0.1) as port, open(args[2], "wb") as out:
+            print("Recording, stop with Ctrl+C")
+            try:
+                capture(port, out, threading.Event())
+            except KeyboardInterrupt:
+                pass
+        with open(args[2], "rb") as f:
+            print(summary(list(records(f.read()))))
+        return 0
+
+    if len(args) >= 4 and args[0] == "replay":
+        with open(args[2], "rb") as f:
+            recs = list(records(f.read()))
+        with serial.Serial(args[1], 115200, timeout=0.1) as port, open(args[3], "wb") as out:
+            stop = threading.Event()
+            reader = threading.Thread(target=capture, args=(port, out, stop))
+            reader.start()
+            start = time.monotonic()
+            offset = 0
+            for prev, rec in zip([recs[0]] + recs, recs):
+                offset += (decode(rec)["time"] - decode(prev)["time"]) & 0xFFFF
+                delay = start + offset / 1000.0 - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+                port.write(rec)
+            time.sleep(1.0)  # the last frames & the end of the replay
+            stop.set()
+            reader.join()
+        print("original: " + summary(recs))
+        with open(args[3], "rb") as f:
+            print("replayed: " + summary(list(records(f.read()))))
+        return 0
+
+    print(__doc__)
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+Telemetry decoder for the "Micro RC" transmitter (PC side, see "telemetry.h").
+Converts the binary telemetry stream of a transmitter with the "TELEMETRY" build option into CSV files, one per
+record type: <prefix>_axes.csv, <prefix>_link.csv, <prefix>_battery.csv, <prefix>_timing.csv, <prefix>_rx.csv
+
+  From the transmitter:   telemetry.py /dev/ttyUSB0 session      (requires pyserial, stop with Ctrl+C)
+  From a raw capture:     telemetry.py capture.bin session
+
+Frames with a wrong CRC are skipped. Gaps in the sequence numbers (records, which were dropped by the transmitter,
+because the Serial buffer was full) are counted.
+Created by TheDIYGuy999
+"""
+
+import csv
+import os
+import struct
+import sys
+
+# Record type: name, payload format (little endian), CSV columns
+RECORDS = {
+    1: ("axes", "<5sBB", ["axis1", "axis2", "axis3", "axis4", "pot", "mode1", "mode2", "momentary1", "received"]),
+    2: ("link", "<HHBBHHHHBB", ["sent_per_s", "acked_per_s", "loss_percent", "retries_x10", "rtt50_us", "rtt90_us",
+                                 "rtt_max_us", "ack_lost", "rate", "pa"]),
+    3: ("battery", "<HHBHHHBHB", ["tx_mv", "tx_vcc_mv", "tx_soc", "tx_runtime_min", "vehicle_mv", "vehicle_vcc_mv",
+                                  "vehicle_soc", "vehicle_runtime_min", "tx_ok", "vehicle_ok"]),
+    4: ("timing", "<HBHHHH", ["frames_per_s", "sleep_percent", "control_wcet_us", "control_jitter_us", "latency_us",
+                              "dropped"]),
+    5: ("rx", "<HHLB", ["frames_per_s", "lost", "frames", "channel"]),
+}
+
+
+def crc_ccitt(data):
+    """Same as _crc_ccitt_update() of the avr-libc, init 0xFFFF."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8408 if crc & 1 else crc >> 1
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame) + 1:
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def fields(kind, values):
+    if kind == 1:
+        axes = int.from_bytes(values[0], "little")
+        flags = values[2]
+        return [(axes >> (10 * n)) & 0x3FF for n in range(4)] + [values[1]] + [(flags >> n) & 1 for n in range(4)]
+    if kind == 3:
+        return list(values[:-1]) + [values[-1] & 1, (values[-1] >> 1) & 1]
+    return list(values)
+
+
+class Decoder:
+    def __init__(self, prefix):
+        self.prefix = prefix
+        self.files = {}
+        self.writers = {}
+        self.buffer = bytearray()
+        self.sequence = None
+        self.time = None
+        self.records = self.bad = self.dropped = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while 0 in self.buffer:
+            end = self.buffer.index(0)
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if frame:
+                self.record(frame)
+
+    def record(self, frame):
+        raw = cobs_decode(frame)
+        if raw is None or len(raw) < 6 or crc_ccitt(raw[:-2]) != raw[-2] | (raw[-1] << 8) or raw[0] not in RECORDS:
+            self.bad += 1
+            return
+        kind, sequence, time = raw[0], raw[1], raw[2] | (raw[3] << 8)
+        name, fmt, columns = RECORDS[kind]
+        if len(raw) - 6 != struct.calcsize(fmt):
+            self.bad += 1
+            return
+        if self.sequence is not None:
+            self.dropped += (sequence - self.sequence - 1) & 0xFF
+        self.sequence = sequence
+        self.time = time if self.time is None else self.time + ((time - self.time) & 0xFFFF)  # 16 bit ms unwrapped
+
+        if kind not in self.writers:
+            self.files[kind] = open("%s_%s.csv" % (self.prefix, name), "w", newline="")
+            self.writers[kind] = csv.writer(self.files[kind])
+            self.writers[kind].writerow(["time_ms", "sequence"] + columns)
+        self.writers[kind].writerow([self.time, sequence] + fields(kind, struct.unpack(fmt, raw[4:-2])))
+        self.records += 1
+
+    def close(self):
+        for f in self.files.values():
+            f.close()
+        print("%d records, %d dropped by the transmitter, %d invalid frames" % (self.records, self.dropped, self.bad))
+
+
+def main(args):
+    if len(args) != 2:
+        print(__doc__)
+        return 1
+    decoder = Decoder(args[1])
+    try:
+        if os.path.isfile(args[0]):
+            with open(args[0], "rb") as f:
+                decoder.feed(f.read())
+        else:
+            import serial
+            with serial.Serial(args[0], 115200, timeout=0.1) as port:
+                print("Decoding, stop with Ctrl+C")
+                while True:
+                    decoder.feed(port.read(256))
+    except KeyboardInterrupt:
+        pass
+    decoder.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
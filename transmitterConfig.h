@@ -3,7 +3,9 @@
 
 #include "Arduino.h"
 
-#define CONFIG_WLTOYS_2 // <- Select the correct transmitter configuration here before uploading!
+#if !defined CONFIG_MICRO_RC && !defined CONFIG_2_CH && !defined CONFIG_3_CH && !defined CONFIG_WLTOYS && !defined CONFIG_WLTOYS_2 && !defined CONFIG_WLTOYS_MINI
+#define CONFIG_WLTOYS_2 // <- Select the correct transmitter configuration here before uploading! (the host build selects it with -D)
+#endif
 
 //
 // =======================================================================================================
@@ -11,169 +13,244 @@
 // =======================================================================================================
 //
 
+// Each configuration is a "txProfile" type with constants only. So the unused channel code is removed by the
+// compiler and inconsistent settings are reported during compilation (see the checks at the end of this file)
+
+// Channel bits (for "channels" & "switches")
+const byte CH1 = bit(0);
+const byte CH2 = bit(1);
+const byte CH3 = bit(2);
+const byte CH4 = bit(3);
+
+// Joystick calibration of channel 1 - 4 ----
+constexpr int profileRange(byte ch, int range1, int range2, int range3, int range4) {
+  return ch == 0 ? range1 : ch == 1 ? range2 : ch == 2 ? range3 : range4;
+}
+
 // Configuration for the standard "Micro RC" transmitter with 4 channels and IR support----------------------
 #ifdef CONFIG_MICRO_RC
-// Battery type
-const float cutoffVoltage = 4.4; // 4 x Eneloop cell
-const float diodeDrop = 0.72;
+struct txProfile {
+  // Battery type
+  static constexpr uint16_t cutoffMillivolts = 4400; // 4 x Eneloop cell
+  static constexpr uint16_t diodeDropMillivolts = 720;
 
-// Channels, we have
-#define CH1
-#define CH2 
-#define CH3
-#define CH4
+  // General settings
+  static constexpr bool ledInversed = false; // true = LED common is wired to VCC, so we have to inverse the logic!
 
-// Infrared
-boolean infrared = true;
+  // Channels, we have
+  static constexpr byte channels = CH1 | CH2 | CH3 | CH4;
 
-// Board type
-const float boardVersion = 1.1; // Board revision (MUST MATCH WITH YOUR BOARD REVISION!!)
+  // 3 position switches, we have (= no auto calibtation for these channels during startup)
+  static constexpr byte switches = 0;
 
-// Joystick calibration
-int range[4] = {1023, 1023, 1023, 1023}; // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
-int reverseEndpoint = 0; // the point, where the throttle joystick hits its reverse end stop
+  // Infrared
+  static constexpr bool infrared = true;
+
+  // Board type
+  static constexpr byte boardVersion = 11; // Board revision * 10, 11 = 1.1 (MUST MATCH WITH YOUR BOARD REVISION!!)
+
+  // Joystick calibration
+  static constexpr int range(byte ch) { // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
+    return profileRange(ch, 1023, 1023, 1023, 1023);
+  }
+  static constexpr int reverseEndpoint = 0; // the point, where the throttle joystick hits its reverse end stop
+};
 
 #endif
 
 // Configuration for a 2 channel transmitter with steering wheel. No IR support----------------------
 #ifdef CONFIG_2_CH
-// Battery type
-const float cutoffVoltage = 4.4; // 4 x Eneloop cell
-const float diodeDrop = 0.3;
+struct txProfile {
+  // Battery type
+  static constexpr uint16_t cutoffMillivolts = 4400; // 4 x Eneloop cell
+  static constexpr uint16_t diodeDropMillivolts = 300;
+
+  // General settings
+  static constexpr bool ledInversed = false; // true = LED common is wired to VCC, so we have to inverse the logic!
 
-// Channels, we have
-#define CH1
-#define CH3
+  // Channels, we have
+  static constexpr byte channels = CH1 | CH3;
 
-// Infrared
-boolean infrared = false;
+  // 3 position switches, we have (= no auto calibtation for these channels during startup)
+  static constexpr byte switches = 0;
 
-// Board type
-const float boardVersion = 1.1; // Board revision (MUST MATCH WITH YOUR BOARD REVISION!!)
+  // Infrared
+  static constexpr bool infrared = false;
 
-// Joystick calibration
-int range[4] = {820, 820, 820, 820}; // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
-int reverseEndpoint = 273; // the point, where the throttle joystick hits its reverse end stop
+  // Board type
+  static constexpr byte boardVersion = 11; // Board revision * 10, 11 = 1.1 (MUST MATCH WITH YOUR BOARD REVISION!!)
+
+  // Joystick calibration
+  static constexpr int range(byte ch) { // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
+    return profileRange(ch, 820, 820, 820, 820);
+  }
+  static constexpr int reverseEndpoint = 273; // the point, where the throttle joystick hits its reverse end stop
+};
 
 #endif
 
 // Configuration for a 2+1 channel transmitter with steering wheel. No IR support----------------------
 #ifdef CONFIG_3_CH
-// Battery type
-const float cutoffVoltage = 4.4; // 4 x Eneloop cell
-const float diodeDrop = 0.3;
+struct txProfile {
+  // Battery type
+  static constexpr uint16_t cutoffMillivolts = 4400; // 4 x Eneloop cell
+  static constexpr uint16_t diodeDropMillivolts = 300;
+
+  // General settings
+  static constexpr bool ledInversed = false; // true = LED common is wired to VCC, so we have to inverse the logic!
 
-// Channels, we have
-#define CH1
-#define CH2 // switch with one resistor to gnd and one to vcc (for 3 speed gearbox) 
-#define CH3
+  // Channels, we have
+  static constexpr byte channels = CH1 | CH2 | CH3;
+  // CH2: switch with one resistor to gnd and one to vcc (for 3 speed gearbox)
 
-// 3 position switches, we have (= no auto calibtation for these channels during startup)
-#define CH2Switch
+  // 3 position switches, we have (= no auto calibtation for these channels during startup)
+  static constexpr byte switches = CH2;
 
-// Infrared
-boolean infrared = false;
+  // Infrared
+  static constexpr bool infrared = false;
 
-// Board type
-const float boardVersion = 1.1; // Board revision (MUST MATCH WITH YOUR BOARD REVISION!!)
+  // Board type
+  static constexpr byte boardVersion = 11; // Board revision * 10, 11 = 1.1 (MUST MATCH WITH YOUR BOARD REVISION!!)
 
-// Joystick calibration
-int range[4] = {820, 820, 820, 820}; // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
-int reverseEndpoint = 273; // the point, where the throttle joystick hits its reverse end stop
+  // Joystick calibration
+  static constexpr int range(byte ch) { // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
+    return profileRange(ch, 820, 820, 820, 820);
+  }
+  static constexpr int reverseEndpoint = 273; // the point, where the throttle joystick hits its reverse end stop
+};
 
 #endif
 
 // Configuration for a 2+1 channel transmitter with steering wheel. Based on a WLtoys transmitter. No IR support----------------------
 #ifdef CONFIG_WLTOYS
-// Battery type
-const float cutoffVoltage = 4.4; // 4 x Eneloop cell
-const float diodeDrop = 0.0; // No protection diode in this transmitter
+struct txProfile {
+  // Battery type
+  static constexpr uint16_t cutoffMillivolts = 4400; // 4 x Eneloop cell
+  static constexpr uint16_t diodeDropMillivolts = 0; // No protection diode in this transmitter
 
-// General settings
-#define ledInversed // LED common is wired to VCC, so we have to inverse the logic!
+  // General settings
+  static constexpr bool ledInversed = true; // true = LED common is wired to VCC, so we have to inverse the logic!
 
-// Channels, we have
-#define CH1 // Steering
-#define CH2 // switch with one resistor to gnd and one to vcc (for 3 speed gearbox) 
-#define CH3 // Throttle
+  // Channels, we have
+  static constexpr byte channels = CH1 | CH2 | CH3;
+  // CH1: Steering
+  // CH2: switch with one resistor to gnd and one to vcc (for 3 speed gearbox)
+  // CH3: Throttle
 
-// 3 position switches, we have (= no auto calibtation for these channels during startup)
-#define CH2Switch
+  // 3 position switches, we have (= no auto calibtation for these channels during startup)
+  static constexpr byte switches = CH2;
 
-// Infrared
-boolean infrared = false;
+  // Infrared
+  static constexpr bool infrared = false;
 
-// Board type
-const float boardVersion = 1.1; // Board revision (MUST MATCH WITH YOUR BOARD REVISION!!)
+  // Board type
+  static constexpr byte boardVersion = 11; // Board revision * 10, 11 = 1.1 (MUST MATCH WITH YOUR BOARD REVISION!!)
 
-// Joystick calibration
-int range[4] = {900, 900, 900, 900}; // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
-int reverseEndpoint = 170; // the point, where the throttle joystick hits its reverse end stop
+  // Joystick calibration
+  static constexpr int range(byte ch) { // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
+    return profileRange(ch, 900, 900, 900, 900);
+  }
+  static constexpr int reverseEndpoint = 170; // the point, where the throttle joystick hits its reverse end stop
+};
 
 #endif
 
 // Configuration for a 2+2 channel transmitter with steering wheel. Based on a WLtoys transmitter. No IR support----------------------
 #ifdef CONFIG_WLTOYS_2
-// Battery type
-const float cutoffVoltage = 4.4; // 4 x Eneloop cell
-const float diodeDrop = 0.0; // No protection diode in this transmitter
+struct txProfile {
+  // Battery type
+  static constexpr uint16_t cutoffMillivolts = 4400; // 4 x Eneloop cell
+  static constexpr uint16_t diodeDropMillivolts = 0; // No protection diode in this transmitter
 
-// General settings
-#define ledInversed // LED common is wired to VCC, so we have to inverse the logic!
+  // General settings
+  static constexpr bool ledInversed = true; // true = LED common is wired to VCC, so we have to inverse the logic!
 
-// Channels, we have
-#define CH1 // Steering
-#define CH2 // switch with one resistor to gnd and one to vcc (for 3 speed gearbox) 
-#define CH3 // Throttle
-#define CH4 // 3 x push buttons: 1 pressed = 0V, 2 pressed = 0.76V, 3 pressed = 3.3V, no button pressed = 1.65V
+  // Channels, we have
+  static constexpr byte channels = CH1 | CH2 | CH3 | CH4;
+  // CH1: Steering
+  // CH2: switch with one resistor to gnd and one to vcc (for 3 speed gearbox)
+  // CH3: Throttle
+  // CH4: 3 x push buttons: 1 pressed = 0V, 2 pressed = 0.76V, 3 pressed = 3.3V, no button pressed = 1.65V
 
-// 3 position switches, we have (= no auto calibtation for these channels during startup)
-#define CH2Switch
-#define CH4Switch
+  // 3 position switches, we have (= no auto calibtation for these channels during startup)
+  static constexpr byte switches = CH2 | CH4;
 
-// Infrared
-boolean infrared = false;
+  // Infrared
+  static constexpr bool infrared = false;
 
-// Board type
-const float boardVersion = 1.1; // Board revision (MUST MATCH WITH YOUR BOARD REVISION!!)
+  // Board type
+  static constexpr byte boardVersion = 11; // Board revision * 10, 11 = 1.1 (MUST MATCH WITH YOUR BOARD REVISION!!)
 
-// Joystick calibration
-int range[4] = {890, 900, 900, 900}; // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
-int reverseEndpoint = 170; // the point, where the throttle joystick hits its reverse end stop
+  // Joystick calibration
+  static constexpr int range(byte ch) { // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
+    return profileRange(ch, 890, 900, 900, 900);
+  }
+  static constexpr int reverseEndpoint = 170; // the point, where the throttle joystick hits its reverse end stop
+};
 
 #endif
 
 // Configuration for a 2+2 channel transmitter with steering wheel. Based on a small WLtoys transmitter. No IR support----------------------
 #ifdef CONFIG_WLTOYS_MINI
-// Battery type
-const float cutoffVoltage = 4.4; // 4 x Eneloop cell
-const float diodeDrop = 0.0; // No protection diode in this transmitter
+struct txProfile {
+  // Battery type
+  static constexpr uint16_t cutoffMillivolts = 4400; // 4 x Eneloop cell
+  static constexpr uint16_t diodeDropMillivolts = 0; // No protection diode in this transmitter
 
-// General settings
-//#define ledInversed // LED common is wired to VCC, so we have to inverse the logic!
+  // General settings
+  static constexpr bool ledInversed = false; // true = LED common is wired to VCC, so we have to inverse the logic!
 
-// Channels, we have
-#define CH1 // Steering
-#define CH2 // switch with one resistor to gnd and one to vcc (for 3 speed gearbox) 
-#define CH3 // Throttle
-#define CH4 // 3 x push buttons: 1 pressed = 0V, 2 pressed = 0.76V, 3 pressed = 3.3V, no button pressed = 1.65V
+  // Channels, we have
+  static constexpr byte channels = CH1 | CH2 | CH3 | CH4;
+  // CH1: Steering
+  // CH2: switch with one resistor to gnd and one to vcc (for 3 speed gearbox)
+  // CH3: Throttle
+  // CH4: 3 x push buttons: 1 pressed = 0V, 2 pressed = 0.76V, 3 pressed = 3.3V, no button pressed = 1.65V
 
-// 3 position switches, we have (= no auto calibtation for these channels during startup)
-#define CH2Switch
-#define CH4Switch
+  // 3 position switches, we have (= no auto calibtation for these channels during startup)
+  static constexpr byte switches = CH2 | CH4;
 
-// Infrared
-boolean infrared = false;
+  // Infrared
+  static constexpr bool infrared = false;
 
-// Board type
-const float boardVersion = 1.1; // Board revision (MUST MATCH WITH YOUR BOARD REVISION!!)
+  // Board type
+  static constexpr byte boardVersion = 11; // Board revision * 10, 11 = 1.1 (MUST MATCH WITH YOUR BOARD REVISION!!)
 
-// Joystick calibration
-int range[4] = {900, 900, 800, 900}; // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
-int reverseEndpoint = 170; // the point, where the throttle joystick hits its reverse end stop
+  // Joystick calibration
+  static constexpr int range(byte ch) { // 1023, if entire pot wiper range is used (CH1, 2, 3, 4)
+    return profileRange(ch, 900, 900, 800, 900);
+  }
+  static constexpr int reverseEndpoint = 170; // the point, where the throttle joystick hits its reverse end stop
+};
 
 #endif
 
+//
+// =======================================================================================================
+// CONFIGURATION CHECKS (at compile time)
+// =======================================================================================================
+//
 
+constexpr bool hasChannel(byte ch) {
+  return txProfile::channels & bit(ch);
+}
+
+constexpr bool hasPot(byte ch) { // channel with a potentiometer (auto calibration)
+  return hasChannel(ch) && !(txProfile::switches & bit(ch));
+}
+
+constexpr bool rangesValid(byte ch) {
+  return ch > 3 || (txProfile::range(ch) > 511 && txProfile::range(ch) <= 1023 && rangesValid(ch + 1));
+}
+
+static_assert(txProfile::channels != 0 && !(txProfile::channels & ~(CH1 | CH2 | CH3 | CH4)), "channels: CH1 - CH4 only");
+static_assert(!(txProfile::switches & ~txProfile::channels), "switches: a 3 position switch has to be one of the channels");
+static_assert(rangesValid(0), "range: 512 - 1023 required");
+static_assert(txProfile::reverseEndpoint >= 0 && txProfile::reverseEndpoint < txProfile::range(2) / 2, "reverseEndpoint: has to be below the throttle center");
+static_assert(!txProfile::reverseEndpoint || hasPot(2), "reverseEndpoint: the throttle (CH3) has to be a potentiometer");
+static_assert(!txProfile::infrared || (hasPot(0) && hasPot(1) && hasPot(2) && hasPot(3)), "infrared: 4 joystick channels required");
+static_assert(txProfile::cutoffMillivolts >= 1000, "cutoffMillivolts: at least one cell required");
+static_assert(txProfile::diodeDropMillivolts < 1000, "diodeDropMillivolts: too high");
+static_assert(txProfile::boardVersion >= 10, "boardVersion: revision * 10 required");
 
 #endif